@@ -0,0 +1,944 @@
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "cpp_lexer/MacroSet.h"
+#include "cpp_lexer/cpp_lexer.h"
+#include "lexer/BracketIndex.h"
+#include "lexer/CharClass.h"
+#include "lexer/IncrementalLexer.h"
+#include "lexer/Interner.h"
+#include "lexer/NumberValue.h"
+#include "lexer/ParallelLexer.h"
+#include "lexer/SourceBuffer.h"
+#include "lexer/StreamLexer.h"
+#include "lexer/StringValue.h"
+#include "lexer/TestLexer.h"
+#include "lexer/TokenBuffer.h"
+
+static std::atomic<std::size_t> g_allocations = 0;
+static volatile std::size_t g_sink;
+
+void *operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+
+    if(void *p = std::malloc(size)) {
+        return p;
+    }
+
+    throw std::bad_alloc();
+}
+
+// GCC 12 sees free() on memory from operator new once both are inlined into
+// the same container code, it does not know they are this pair
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+#pragma GCC diagnostic pop
+
+struct Options {
+    std::string format = "table";
+    std::size_t size = 8 * 1024 * 1024;
+    int warmup = 2;
+    int reps = 10;
+    std::vector<std::string> corpora;
+};
+
+// rows that do not lex count the items they process (bytes classified, names
+// looked up, tokens relexed) as tokens
+struct Stats {
+    std::size_t bytes;
+    std::size_t tokens;
+    std::size_t errors;
+    int reps;
+    double mb_s_mean;
+    double mb_s_stddev;
+    double mb_s_min;
+    double mb_s_max;
+    double tokens_s;
+    double ns_per_token;
+    double allocations_per_token;
+    double token_bytes;
+    long rss_growth_kb;
+};
+
+struct Result {
+    std::string lexer;
+    std::string corpus;
+    Stats stats;
+};
+
+// deterministic so that runs on different commits see the same input
+class Random {
+    std::uint64_t m_state;
+
+public:
+    explicit Random(std::uint64_t seed) : m_state(seed) {}
+
+    std::uint32_t next() {
+        m_state = m_state * 6364136223846793005 + 1442695040888963407;
+        return static_cast<std::uint32_t>(m_state >> 33);
+    }
+
+    template<std::size_t N>
+    const char *pick(const char *const (&items)[N]) {
+        return items[next() % N];
+    }
+};
+
+std::string synthetic_cpp(std::size_t size) {
+    static constexpr const char *types[] = {"int", "std::size_t", "const char *", "std::string_view", "double", "auto", "Token", "std::vector<int>"};
+    static constexpr const char *names[] = {"value", "m_index", "count", "begin", "end", "result", "token", "lexer_state", "i", "n"};
+    static constexpr const char *ops[] = {" + ", " - ", " * ", " / ", " == ", " != ", " < ", " >= ", " && ", " || ", " << ", " & ", "->", "."};
+    static constexpr const char *literals[] = {"0", "1", "42", "0x7f", "3.14", "1e-9", "'a'", "'\\n'", "\"text\"", "\"escaped \\\"quote\\\"\"", "nullptr", "true"};
+
+    Random random(0x5eed);
+    std::string out;
+    out.reserve(size + 256);
+
+    while(out.size() < size) {
+        switch(random.next() % 6) {
+        case 0:
+            out += "// ";
+            out += random.pick(names);
+            out += " is updated below\n";
+            break;
+        case 1:
+            out += "/* block comment\n * spanning lines */\n";
+            break;
+        case 2:
+            out += "#define ";
+            out += random.pick(names);
+            out += "_MAX(a, b) ((a) > (b) ? (a) : (b))\n";
+            break;
+        default:
+            out += "    ";
+            out += random.pick(types);
+            out += ' ';
+            out += random.pick(names);
+            out += " = ";
+
+            for(std::uint32_t i = 0, terms = random.next() % 4; i < terms; i++) {
+                out += random.pick(names);
+                out += random.pick(ops);
+            }
+
+            out += random.pick(literals);
+            out += ";\n";
+        }
+    }
+
+    return out;
+}
+
+// only what TestLexer understands
+std::string synthetic_expressions(std::size_t size) {
+    static constexpr const char *names[] = {"a", "blah", "name", "a_good_num", "x1", "total"};
+    static constexpr const char *ops[] = {" + ", " - ", " * ", " / ", " ^ ", " ** "};
+    static constexpr const char *literals[] = {"1", "42", "10e-3", "2.5", "\"string\"", "\"with \\\"quotes\\\"\""};
+
+    Random random(0x5eed);
+    std::string out;
+    out.reserve(size + 256);
+
+    while(out.size() < size) {
+        out += random.pick(names);
+        out += " = ";
+
+        for(std::uint32_t i = 0, terms = random.next() % 5; i < terms; i++) {
+            out += random.next() % 4 ? random.pick(literals) : "(1 + 2)";
+            out += random.pick(ops);
+        }
+
+        out += random.pick(literals);
+        out += ";\n";
+    }
+
+    return out;
+}
+
+// a stray character every ~1000 bytes and an unterminated string and comment
+std::string dirty(std::string_view code) {
+    std::string out;
+
+    for(std::size_t offset = 0; offset < code.size(); offset += 997) {
+        out += code.substr(offset, 997);
+        out += '@';
+    }
+
+    out += "\n1e+ \"abc\nx /* y\nz";
+    return out;
+}
+
+// a generated table, the kind of input where numbers dominate
+std::string number_table(std::size_t size) {
+    Random random(0x5eed);
+    std::string out = "const unsigned long long table[] = {\n";
+
+    for(std::size_t i = 0; out.size() < size; i++) {
+        const std::uint64_t x = static_cast<std::uint64_t>(random.next()) << 32 | random.next();
+        char entry[64];
+        std::snprintf(entry, sizeof(entry), i % 3 == 0 ? "0x%llxull, " : i % 3 == 1 ? "%llu, " : "%llu.25e-3, ", static_cast<unsigned long long>(i % 3 == 2 ? x >> 40 : x));
+        out += entry;
+
+        if(i % 8 == 7) {
+            out += '\n';
+        }
+    }
+
+    out += "};\n";
+    return out;
+}
+
+// a message table, one literal in four with escapes
+std::string string_table(std::size_t size) {
+    std::string out = "const char *messages[] = {\n";
+
+    for(std::size_t i = 0; out.size() < size; i++) {
+        out += i % 4 == 0 ? "    \"line\\tnumber \\x41\\n\",\n" : "    \"a message without escapes in it\",\n";
+    }
+
+    out += "};\n";
+    return out;
+}
+
+// platform conditional blocks, only the last of three copies of code is live
+std::string conditional_header(std::string_view code, std::size_t size) {
+    std::string out;
+
+    while(out.size() < size) {
+        out += "#if defined(_WIN32)\n";
+        out += code;
+        out += "\n#elif defined(__APPLE__)\n";
+        out += code;
+        out += "\n#else\n";
+        out += code;
+        out += "\n#endif\n";
+    }
+
+    return out;
+}
+
+long peak_rss_kb() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+Stats summarize(std::size_t bytes, std::size_t tokens, const std::vector<double> &rates, double elapsed, std::size_t total_tokens, std::size_t allocations) {
+    double mean = 0;
+
+    for(double rate : rates) {
+        mean += rate;
+    }
+
+    mean /= static_cast<double>(rates.size());
+    double variance = 0;
+
+    for(double rate : rates) {
+        variance += (rate - mean) * (rate - mean);
+    }
+
+    variance /= rates.size() > 1 ? static_cast<double>(rates.size() - 1) : 1;
+    const double token_count = std::max<double>(static_cast<double>(total_tokens), 1);
+
+    return {
+        bytes,
+        tokens,
+        0,
+        static_cast<int>(rates.size()),
+        mean,
+        std::sqrt(variance),
+        *std::min_element(rates.begin(), rates.end()),
+        *std::max_element(rates.begin(), rates.end()),
+        static_cast<double>(total_tokens) / elapsed,
+        elapsed * 1e9 / token_count,
+        static_cast<double>(allocations) / token_count,
+        0,
+        0,
+    };
+}
+
+// times options.reps calls of pass after options.warmup untimed ones. A pass
+// goes through bytes of input and returns the number of tokens it produced.
+template<typename Pass_F>
+Stats measure(std::size_t bytes, const Options &options, Pass_F pass) {
+    std::vector<double> rates;
+    rates.reserve(options.reps);
+
+    for(int i = 0; i < options.warmup; i++) {
+        pass();
+    }
+
+    double elapsed = 0;
+    std::size_t tokens = 0;
+    std::size_t total_tokens = 0;
+    std::size_t allocations = g_allocations.load();
+
+    for(int i = 0; i < options.reps; i++) {
+        auto start = std::chrono::steady_clock::now();
+        tokens = pass();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        elapsed += seconds;
+        total_tokens += tokens;
+        rates.push_back(static_cast<double>(bytes) / seconds / 1e6);
+    }
+
+    allocations = g_allocations.load() - allocations;
+    return summarize(bytes, tokens, rates, elapsed, total_tokens, allocations);
+}
+
+// measures a row in a child process, so that the RSS it reports is what the row
+// itself needed and not the largest of every row before it
+template<typename Measure_F>
+bool add(std::vector<Result> &results, std::string lexer_name, std::string corpus_name, Measure_F measure_row) {
+    int fds[2];
+
+    if(pipe(fds) != 0) {
+        std::perror("pipe");
+        return false;
+    }
+
+    std::fflush(stdout);
+    std::fflush(stderr);
+    const pid_t pid = fork();
+
+    if(pid < 0) {
+        std::perror("fork");
+        return false;
+    }
+
+    if(pid == 0) {
+        close(fds[0]);
+
+        // starts out as the RSS inherited from the parent
+        const long start_kb = peak_rss_kb();
+        Stats stats = measure_row();
+        stats.rss_growth_kb = peak_rss_kb() - start_kb;
+
+        const bool sent = write(fds[1], &stats, sizeof(stats)) == sizeof(stats);
+        _exit(sent ? 0 : 1);
+    }
+
+    close(fds[1]);
+    Stats stats{};
+    const bool received = read(fds[0], &stats, sizeof(stats)) == sizeof(stats);
+    close(fds[0]);
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+
+    if(!received || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        std::fprintf(stderr, "%s on %s did not finish\n", lexer_name.c_str(), corpus_name.c_str());
+        return false;
+    }
+
+    results.push_back({std::move(lexer_name), std::move(corpus_name), stats});
+    return true;
+}
+
+template<typename Token_T, typename Lexer_T>
+Stats run(Lexer_T &lexer, std::string_view code, const Options &options) {
+    std::vector<Token_T> tokens;
+    std::vector<typename Lexer_T::Error> errors;
+
+    Stats stats = measure(code.size(), options, [&]() {
+        tokens.clear();
+        errors.clear();
+        lexer.lex(code, tokens, errors);
+        return tokens.size();
+    });
+
+    stats.errors = errors.size();
+    stats.token_bytes = sizeof(Token_T);
+    return stats;
+}
+
+template<typename Lexer_T, typename Token_T>
+bool run(std::vector<Result> &results, const char *lexer_name, const std::string &corpus_name, std::string_view code, const Options &options) {
+    return add(results, lexer_name, corpus_name, [&]() {
+        Lexer_T lexer;
+        return run<Token_T>(lexer, code, options);
+    });
+}
+
+// a request scoped service: every request gets fresh vectors from the global heap
+struct HeapRequest {
+    explicit HeapRequest(std::string_view) {}
+
+    std::size_t operator()(std::string_view code) {
+        cpp_lexer::Lexer lexer;
+        std::vector<cpp_lexer::Token> tokens;
+        std::vector<LexError> errors;
+        lexer.lex(code, tokens, errors);
+        return tokens.size();
+    }
+};
+
+// the same with every request's memory taken from a per-thread monotonic arena,
+// released in one go when the request ends
+struct ArenaRequest {
+    std::vector<std::byte> m_storage;
+
+    // room for the tokens and what vector growth leaves behind in a monotonic arena
+    explicit ArenaRequest(std::string_view code) : m_storage(code.size() * 16 + 64 * 1024) {}
+
+    std::size_t operator()(std::string_view code) {
+        std::pmr::monotonic_buffer_resource arena(m_storage.data(), m_storage.size());
+        cpp_lexer::PmrLexer lexer;
+        std::pmr::vector<cpp_lexer::Token> tokens(&arena);
+        std::pmr::vector<LexError> errors(&arena);
+        lexer.lex(code, tokens, errors);
+        return tokens.size();
+    }
+};
+
+// threads each serve requests for code until about options.size bytes are lexed in total
+template<typename Request_T>
+bool run_requests(std::vector<Result> &results, const char *lexer_name, std::size_t threads, std::string_view code, const Options &options) {
+    const std::string corpus_name = "sample.h, " + std::to_string(threads) + " threads";
+
+    return add(results, lexer_name, corpus_name, [&]() {
+        const std::size_t requests = std::max<std::size_t>(options.size / std::max<std::size_t>(code.size(), 1) / threads, 1);
+        std::vector<std::size_t> tokens(threads);
+
+        // thread start up allocates too, a handful per pass
+        Stats stats = measure(code.size() * requests * threads, options, [&]() {
+            std::vector<std::thread> workers;
+            workers.reserve(threads);
+
+            for(std::size_t t = 0; t < threads; t++) {
+                workers.emplace_back([&, t]() {
+                    Request_T request(code);
+                    tokens[t] = 0;
+
+                    for(std::size_t i = 0; i < requests; i++) {
+                        tokens[t] += request(code);
+                    }
+                });
+            }
+
+            for(auto &worker : workers) {
+                worker.join();
+            }
+
+            std::size_t total = 0;
+
+            for(std::size_t count : tokens) {
+                total += count;
+            }
+
+            return total;
+        });
+
+        stats.bytes = code.size();
+        stats.tokens /= requests * threads;
+        stats.token_bytes = sizeof(cpp_lexer::Token);
+        return stats;
+    });
+}
+
+template<typename Lexer_T, typename Token_T>
+bool run_file(std::vector<Result> &results, const char *lexer_name, const std::string &path, const Options &options) {
+    SourceBuffer source;
+
+    if(!source.open(path.c_str())) {
+        std::fprintf(stderr, "failed to read %s\n", path.c_str());
+        return false;
+    }
+
+    return run<Lexer_T, Token_T>(results, lexer_name, path.substr(path.find_last_of('/') + 1), source.view(), options);
+}
+
+// the cpp_lexer features against plain lexing of the same input
+bool run_features(std::vector<Result> &results, std::string_view code, const Options &options) {
+    using cpp_lexer::Lexer;
+    using cpp_lexer::Token;
+
+    const std::string corpus = "sample.h (repeated)";
+    bool ok = true;
+
+    ok = ok && add(results, "pull", corpus, [&]() {
+        Lexer lexer;
+        std::vector<Lexer::Error> errors;
+        Token token;
+
+        return measure(code.size(), options, [&]() {
+            std::size_t count = 0;
+            errors.clear();
+            lexer.start(code, errors);
+
+            while(lexer.next_token(token)) {
+                count++;
+            }
+
+            return count;
+        });
+    });
+
+    ok = ok && add(results, "buffer", corpus, [&]() {
+        Lexer lexer;
+        TokenBuffer<Token> buffer;
+        std::vector<Lexer::Error> errors;
+
+        Stats stats = measure(code.size(), options, [&]() {
+            buffer.clear();
+            errors.clear();
+            lexer.lex(code, buffer, errors);
+            return buffer.size();
+        });
+
+        stats.token_bytes = static_cast<double>(buffer.memory_usage()) / std::max<std::size_t>(buffer.size(), 1);
+        return stats;
+    });
+
+    // counting one kind, which only reads the kinds array of a TokenBuffer
+    ok = ok && add(results, "scan vector", corpus, [&]() {
+        Lexer lexer;
+        std::vector<Token> tokens;
+        std::vector<Lexer::Error> errors;
+        lexer.lex(code, tokens, errors);
+
+        return measure(code.size(), options, [&]() {
+            std::size_t count = 0;
+
+            for(const auto &token : tokens) {
+                count += token.value == Token::Kind::semicolon;
+            }
+
+            g_sink = count;
+            return tokens.size();
+        });
+    });
+
+    ok = ok && add(results, "scan buffer", corpus, [&]() {
+        Lexer lexer;
+        TokenBuffer<Token> buffer;
+        std::vector<Lexer::Error> errors;
+        lexer.lex(code, buffer, errors);
+
+        return measure(code.size(), options, [&]() {
+            g_sink = buffer.count(Token::Kind::semicolon);
+            return buffer.size();
+        });
+    });
+
+    ok = ok && add(results, "parallel", corpus + ", " + std::to_string(std::thread::hardware_concurrency()) + " threads", [&]() {
+        ParallelLexer<Lexer, Token> lexer;
+        return run<Token>(lexer, code, options);
+    });
+
+    ok = ok && add(results, "skipping", corpus, [&]() {
+        Lexer lexer;
+        lexer.set_skip_comments(true);
+        lexer.set_skip_macros(true);
+        return run<Token>(lexer, code, options);
+    });
+
+    ok = ok && add(results, "brackets", corpus, [&]() {
+        BracketIndex brackets;
+        Lexer lexer;
+        lexer.set_bracket_index(&brackets);
+        return run<Token>(lexer, code, options);
+    });
+
+    ok = ok && add(results, "interning", corpus, [&]() {
+        Interner interner;
+        Lexer lexer;
+        lexer.set_interner(&interner);
+        return run<Token>(lexer, code, options);
+    });
+
+    const std::string dirty_code = dirty(code);
+
+    ok = ok && add(results, "recovering", "dirty", [&]() {
+        Lexer lexer;
+        lexer.set_error_recovery(true);
+        return run<Token>(lexer, dirty_code, options);
+    });
+
+    // decoded while lexing against converting the text of every number afterwards
+    const std::string numbers = number_table(options.size);
+
+    ok = ok && add(results, "reparse", "number table", [&]() {
+        Lexer lexer;
+        std::vector<Token> tokens;
+        std::vector<Lexer::Error> errors;
+        std::vector<NumberValue> values;
+
+        return measure(numbers.size(), options, [&]() {
+            tokens.clear();
+            errors.clear();
+            values.clear();
+            lexer.lex(numbers, tokens, errors);
+
+            for(const auto &token : tokens) {
+                if(token.value == Token::Kind::number) {
+                    const std::string text(token.text);
+                    NumberValue value;
+
+                    if(text.find_first_of(".e") != std::string::npos && !text.starts_with("0x")) {
+                        value.type = NumberValue::Type::floating;
+                        value.floating = std::strtod(text.c_str(), nullptr);
+                    } else {
+                        value.integer = std::strtoull(text.c_str(), nullptr, 0);
+                    }
+
+                    values.push_back(value);
+                }
+            }
+
+            return tokens.size();
+        });
+    });
+
+    ok = ok && add(results, "numbers", "number table", [&]() {
+        NumberValues values;
+        Lexer lexer;
+        lexer.set_number_values(&values);
+        return run<Token>(lexer, numbers, options);
+    });
+
+    // decoded while lexing against stripping the quotes and decoding every literal afterwards
+    const std::string strings = string_table(options.size);
+
+    ok = ok && add(results, "decode", "string table", [&]() {
+        Lexer lexer;
+        std::vector<Token> tokens;
+        std::vector<Lexer::Error> errors;
+        std::vector<std::string> values;
+
+        return measure(strings.size(), options, [&]() {
+            tokens.clear();
+            errors.clear();
+            values.clear();
+            lexer.lex(strings, tokens, errors);
+
+            for(const auto &token : tokens) {
+                if(token.value == Token::Kind::string) {
+                    const std::string_view body = token.text.substr(1, token.text.size() - 2);
+                    std::string value(body.size(), '\0');
+                    value.resize(decode_escapes(body, value.data()));
+                    values.push_back(std::move(value));
+                }
+            }
+
+            return tokens.size();
+        });
+    });
+
+    ok = ok && add(results, "strings", "string table", [&]() {
+        StringValues values;
+        Lexer lexer;
+        lexer.set_string_values(&values);
+        return run<Token>(lexer, strings, options);
+    });
+
+    // sample.h has an include guard, synthetic code can be repeated in every block
+    const std::string header = conditional_header(synthetic_cpp(16 * 1024), options.size);
+
+    ok = ok && run<Lexer, Token>(results, "cpp_lexer", "#if blocks", header, options);
+    ok = ok && add(results, "macros", "#if blocks", [&]() {
+        cpp_lexer::MacroSet macros;
+        macros.define("__linux__");
+        macros.define("__cplusplus", "202002L");
+
+        Lexer lexer;
+        lexer.set_macros(&macros);
+        return run<Token>(lexer, header, options);
+    });
+
+    for(std::size_t chunk_size : {7, 4096, 65536}) {
+        ok = ok && add(results, "stream/" + std::to_string(chunk_size), corpus, [&]() {
+            std::vector<Token> tokens;
+            std::vector<Lexer::Error> errors;
+
+            return measure(code.size(), options, [&]() {
+                StreamLexer<Lexer, Token> stream;
+                std::size_t count = 0;
+                errors.clear();
+
+                for(std::size_t offset = 0; offset < code.size(); offset += chunk_size) {
+                    tokens.clear();
+                    stream.feed(code.substr(offset, chunk_size), tokens, errors);
+                    count += tokens.size();
+                }
+
+                tokens.clear();
+                stream.finish(tokens, errors);
+                return count + tokens.size();
+            });
+        });
+    }
+
+    // type a character somewhere and delete it again. MB/s is the size of the
+    // document kept up to date per second, against lexing all of it per edit
+    ok = ok && add(results, "incremental", corpus, [&]() {
+        static constexpr std::size_t edits = 100;
+
+        std::string document(code);
+        Lexer lexer;
+        IncrementalLexer<Lexer, Token> incremental;
+        std::vector<Token> tokens;
+        std::vector<Lexer::Error> errors;
+        Random random(1);
+        lexer.lex(document, tokens, errors);
+
+        return measure(document.size() * edits, options, [&]() {
+            std::size_t relexed = 0;
+
+            for(std::size_t i = 0; i < edits; i += 2) {
+                const std::size_t offset = random.next() % document.size();
+                relexed += incremental.apply(document, {offset, 0, "x"}, tokens, errors);
+                relexed += incremental.apply(document, {offset, 1, ""}, tokens, errors);
+            }
+
+            return relexed;
+        });
+    });
+
+    return ok;
+}
+
+// the tables and hashes the lexer is built on, against the obvious alternative
+bool run_parts(std::vector<Result> &results, std::string_view code, const Options &options) {
+    using cpp_lexer::Token;
+
+    const std::string corpus = "sample.h (repeated)";
+    bool ok = true;
+
+    ok = ok && add(results, "cctype", corpus, [&]() {
+        return measure(code.size(), options, [&]() {
+            std::size_t sum = 0;
+
+            for(char c : code) {
+                const auto u = static_cast<unsigned char>(c);
+                sum += std::isspace(u) ? 1 : std::isalpha(u) ? 2 : std::isdigit(u) ? 3 : 0;
+            }
+
+            g_sink = sum;
+            return code.size();
+        });
+    });
+
+    ok = ok && add(results, "char_class", corpus, [&]() {
+        return measure(code.size(), options, [&]() {
+            std::size_t sum = 0;
+
+            for(char c : code) {
+                sum += char_class::is(c, char_class::space) ? 1 : char_class::is(c, char_class::ident_start) ? 2 : char_class::is(c, char_class::digit) ? 3 : 0;
+            }
+
+            g_sink = sum;
+            return code.size();
+        });
+    });
+
+    std::vector<Token> tokens;
+    std::vector<LexError> errors;
+    cpp_lexer::Lexer().lex(code, tokens, errors);
+
+    std::vector<std::string_view> words;
+    std::vector<std::string_view> names;
+    std::size_t word_bytes = 0;
+    std::size_t name_bytes = 0;
+
+    for(const auto &token : tokens) {
+        if(token.value == Token::Kind::identifier || Token::index(token.value) >= Token::index(Token::Kind::kw_alignas)) {
+            words.push_back(token.text);
+            word_bytes += token.text.size();
+        }
+
+        if(token.value == Token::Kind::identifier) {
+            names.push_back(token.text);
+            name_bytes += token.text.size();
+        }
+    }
+
+    ok = ok && add(results, "keyword hash", "identifiers", [&]() {
+        return measure(word_bytes, options, [&]() {
+            std::size_t sum = 0;
+
+            for(auto word : words) {
+                sum += Token::index(Token::identifier_kind(word));
+            }
+
+            g_sink = sum;
+            return words.size();
+        });
+    });
+
+    ok = ok && add(results, "keyword scan", "identifiers", [&]() {
+        return measure(word_bytes, options, [&]() {
+            std::size_t sum = 0;
+
+            for(auto word : words) {
+                auto it = std::find(Token::keywords.begin(), Token::keywords.end(), word);
+                sum += it == Token::keywords.end() ? Token::index(Token::Kind::identifier) : Token::index(Token::Kind::kw_alignas) + (it - Token::keywords.begin());
+            }
+
+            g_sink = sum;
+            return words.size();
+        });
+    });
+
+    // every thread interns all names into one shared table
+    for(bool cached : {false, true}) {
+        for(std::size_t thread_count : {1, 2, 4, 8}) {
+            ok = ok && add(results, cached ? "interner+cache" : "interner", "identifiers, " + std::to_string(thread_count) + " threads", [&]() {
+                Interner shared;
+
+                return measure(name_bytes * thread_count, options, [&]() {
+                    std::vector<std::thread> threads;
+
+                    for(std::size_t t = 0; t < thread_count; t++) {
+                        threads.emplace_back([&shared, &names, cached]() {
+                            Interner::Cache cache(shared);
+                            std::size_t sum = 0;
+
+                            for(auto name : names) {
+                                sum += cached ? cache.intern(name) : shared.intern(name);
+                            }
+
+                            g_sink = sum;
+                        });
+                    }
+
+                    for(auto &thread : threads) {
+                        thread.join();
+                    }
+
+                    return names.size() * thread_count;
+                });
+            });
+        }
+    }
+
+    return ok;
+}
+
+void print(const std::vector<Result> &results, const std::string &format) {
+    if(format == "csv") {
+        std::printf("lexer,corpus,bytes,tokens,errors,reps,mb_s_mean,mb_s_stddev,mb_s_min,mb_s_max,tokens_s,ns_per_token,allocations_per_token,token_bytes,rss_growth_kb\n");
+
+        for(const auto &[lexer, corpus, r] : results) {
+            std::printf("%s,%s,%zu,%zu,%zu,%d,%.3f,%.3f,%.3f,%.3f,%.0f,%.3f,%.6f,%.2f,%ld\n", lexer.c_str(), corpus.c_str(), r.bytes, r.tokens, r.errors, r.reps, r.mb_s_mean, r.mb_s_stddev, r.mb_s_min, r.mb_s_max, r.tokens_s, r.ns_per_token, r.allocations_per_token, r.token_bytes, r.rss_growth_kb);
+        }
+    } else if(format == "json") {
+        std::printf("[\n");
+
+        for(std::size_t i = 0; i < results.size(); i++) {
+            const auto &[lexer, corpus, r] = results[i];
+            std::printf("  {\"lexer\": \"%s\", \"corpus\": \"%s\", \"bytes\": %zu, \"tokens\": %zu, \"errors\": %zu, \"reps\": %d, \"mb_s_mean\": %.3f, \"mb_s_stddev\": %.3f, \"mb_s_min\": %.3f, \"mb_s_max\": %.3f, \"tokens_s\": %.0f, \"ns_per_token\": %.3f, \"allocations_per_token\": %.6f, \"token_bytes\": %.2f, \"rss_growth_kb\": %ld}%s\n",
+                lexer.c_str(), corpus.c_str(), r.bytes, r.tokens, r.errors, r.reps, r.mb_s_mean, r.mb_s_stddev, r.mb_s_min, r.mb_s_max, r.tokens_s, r.ns_per_token, r.allocations_per_token, r.token_bytes, r.rss_growth_kb, i + 1 < results.size() ? "," : "");
+        }
+
+        std::printf("]\n");
+    } else {
+        std::printf("%-14s %-30s %10s %9s %7s %16s %10s %9s %12s %12s %11s\n", "lexer", "corpus", "bytes", "tokens", "errors", "MB/s", "Mtokens/s", "ns/token", "allocs/token", "bytes/token", "RSS growth");
+
+        for(const auto &[lexer, corpus, r] : results) {
+            std::printf("%-14s %-30s %10zu %9zu %7zu %8.2f +-%5.2f %10.2f %9.2f %12.4f %12.1f %8ld KB\n", lexer.c_str(), corpus.c_str(), r.bytes, r.tokens, r.errors, r.mb_s_mean, r.mb_s_stddev, r.tokens_s / 1e6, r.ns_per_token, r.allocations_per_token, r.token_bytes, r.rss_growth_kb);
+        }
+    }
+}
+
+int usage(const char *name) {
+    std::fprintf(stderr, "usage: %s [--format table|csv|json] [--size BYTES] [--warmup N] [--reps N] [--corpus FILE]...\n", name);
+    return 1;
+}
+
+int main(int argc, char **argv) {
+    Options options;
+
+    for(int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+
+        if(i + 1 >= argc) {
+            return usage(argv[0]);
+        } else if(arg == "--format") {
+            options.format = argv[++i];
+        } else if(arg == "--size") {
+            options.size = std::strtoull(argv[++i], nullptr, 10);
+        } else if(arg == "--warmup") {
+            options.warmup = std::atoi(argv[++i]);
+        } else if(arg == "--reps") {
+            options.reps = std::atoi(argv[++i]);
+        } else if(arg == "--corpus") {
+            options.corpora.push_back(argv[++i]);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+
+    if(options.reps < 1 || (options.format != "table" && options.format != "csv" && options.format != "json")) {
+        return usage(argv[0]);
+    }
+
+    std::vector<Result> results;
+
+    const std::string root = BENCH_SOURCE_DIR;
+    SourceBuffer sample;
+
+    if(!sample.open((root + "/bench/corpus/sample.h").c_str())) {
+        std::fprintf(stderr, "failed to read %s/bench/corpus/sample.h\n", root.c_str());
+        return 1;
+    }
+
+    // the bundled sample is small, repeat it to get past timer resolution
+    std::string repeated;
+
+    while(repeated.size() < options.size) {
+        repeated += sample.view();
+    }
+
+    bool ok = run<cpp_lexer::Lexer, cpp_lexer::Token>(results, "cpp_lexer", "sample.h", sample.view(), options);
+    ok = ok && run<cpp_lexer::Lexer, cpp_lexer::Token>(results, "cpp_lexer", "sample.h (repeated)", repeated, options);
+    ok = ok && run<cpp_lexer::Lexer, cpp_lexer::Token>(results, "cpp_lexer", "synthetic", synthetic_cpp(options.size), options);
+
+    // many concurrent small requests, global heap against a monotonic arena per request
+    for(std::size_t threads : {std::size_t(1), std::max<std::size_t>(8, std::thread::hardware_concurrency())}) {
+        ok = ok && run_requests<HeapRequest>(results, "heap", threads, sample.view(), options);
+        ok = ok && run_requests<ArenaRequest>(results, "arena", threads, sample.view(), options);
+    }
+
+    ok = ok && run_features(results, repeated, options);
+    ok = ok && run_parts(results, repeated, options);
+    ok = ok && run_file<TestLexer, Token>(results, "TestLexer", root + "/lexer/code.txt", options);
+    ok = ok && run<TestLexer, Token>(results, "TestLexer", "synthetic", synthetic_expressions(options.size), options);
+
+    for(const auto &path : options.corpora) {
+        ok = ok && run_file<cpp_lexer::Lexer, cpp_lexer::Token>(results, "cpp_lexer", path, options);
+    }
+
+    if(!ok) {
+        return 1;
+    }
+
+    print(results, options.format);
+    return 0;
+}
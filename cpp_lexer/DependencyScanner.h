@@ -0,0 +1,391 @@
+#ifndef CPP_DEPENDENCY_SCANNER_H
+#define CPP_DEPENDENCY_SCANNER_H
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "cpp_lexer.h"
+#include "lexer/SourceBuffer.h"
+
+namespace cpp_lexer {
+
+struct Include {
+    // the name between the quotes or angle brackets
+    std::string_view name;
+    bool angled;
+    // from __has_include, only a dependency if it exists
+    bool optional;
+    // #include_next or __has_include_next
+    bool next;
+};
+
+// sets the modes find_includes lexes in and restores the ones the lexer had
+class IncludeLexerModes {
+    Lexer &m_lexer;
+    bool m_directives;
+    bool m_recover;
+
+public:
+    explicit IncludeLexerModes(Lexer &lexer) : m_lexer(lexer), m_directives(lexer.directive_mode()), m_recover(lexer.error_recovery()) {
+        m_lexer.set_directive_mode(true);
+        m_lexer.set_error_recovery(true);
+    }
+
+    IncludeLexerModes(const IncludeLexerModes &) = delete;
+    IncludeLexerModes &operator=(const IncludeLexerModes &) = delete;
+
+    ~IncludeLexerModes() {
+        m_lexer.set_directive_mode(m_directives);
+        m_lexer.set_error_recovery(m_recover);
+    }
+};
+
+// Collects the #include, #import, #include_next and __has_include targets of
+// source, in order. Directives in inactive #if branches are included too and
+// includes whose target is a macro are skipped.
+inline void find_includes(Lexer &lexer, std::string_view source, std::vector<Include> &includes) {
+    enum class State {
+        line_start,
+        after_hash,
+        include,
+        has_include,
+        has_include_paren,
+        other,
+    };
+
+    std::vector<Lexer::Error> errors;
+    Token token;
+    State state = State::line_start;
+    bool optional = false;
+    bool next = false;
+
+    IncludeLexerModes modes(lexer);
+    lexer.start(source, errors);
+
+    while(lexer.next_token(token)) {
+        switch(token.value) {
+        case Token::Kind::comment:
+            continue;
+        case Token::Kind::hash:
+            state = state == State::line_start ? State::after_hash : State::other;
+            continue;
+        case Token::Kind::directive_end:
+            state = State::line_start;
+            continue;
+        case Token::Kind::identifier:
+            if(state == State::after_hash && (token.text == "include" || token.text == "import" || token.text == "include_next")) {
+                state = State::include;
+                optional = false;
+                next = token.text == "include_next";
+                continue;
+            }
+
+            if(token.text == "__has_include" || token.text == "__has_include_next") {
+                state = State::has_include;
+                next = token.text == "__has_include_next";
+                continue;
+            }
+
+            break;
+        case Token::Kind::lparen:
+            if(state == State::has_include) {
+                state = State::has_include_paren;
+                optional = true;
+                continue;
+            }
+
+            break;
+        case Token::Kind::header_name:
+        case Token::Kind::string:
+            if(state == State::include || state == State::has_include_paren) {
+                includes.push_back({token.text.substr(1, token.text.size() - 2), token.value == Token::Kind::header_name, optional, next});
+            }
+
+            break;
+        default:
+            break;
+        }
+
+        if(state != State::line_start) {
+            state = State::other;
+        }
+    }
+}
+
+// Finds include targets on disk. Every directory is listed once and the listing
+// is shared by all threads, so resolving an include costs a hash lookup per
+// search directory instead of a stat call.
+class IncludeResolver {
+    using Listing = std::unordered_set<std::string>;
+
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        std::unordered_map<std::string, std::shared_ptr<const Listing>> listings;
+    };
+
+    std::vector<std::string> m_quote_dirs;
+    std::vector<std::string> m_angle_dirs;
+    std::array<Shard, 16> m_shards;
+
+    std::shared_ptr<const Listing> listing(const std::string &dir) {
+        Shard &shard = m_shards[std::hash<std::string>()(dir) % m_shards.size()];
+
+        {
+            std::lock_guard lock(shard.mutex);
+            auto it = shard.listings.find(dir);
+
+            if(it != shard.listings.end()) {
+                return it->second;
+            }
+        }
+
+        // listed outside the lock, a thread racing for the same directory just does it twice
+        auto entries = std::make_shared<Listing>();
+        std::error_code ec;
+
+        for(std::filesystem::directory_iterator it(dir.empty() ? "." : dir, ec), end; !ec && it != end; it.increment(ec)) {
+            if(!it->is_directory(ec)) {
+                entries->insert(it->path().filename().string());
+            }
+        }
+
+        std::lock_guard lock(shard.mutex);
+        return shard.listings.try_emplace(dir, std::move(entries)).first->second;
+    }
+
+    std::optional<std::string> find(const std::string &dir, std::string_view name) {
+        const std::filesystem::path path = (std::filesystem::path(dir) / name).lexically_normal();
+
+        if(listing(path.parent_path().string())->contains(path.filename().string())) {
+            return path.string();
+        }
+
+        return std::nullopt;
+    }
+
+public:
+    // "..." includes search quote_dirs and then angle_dirs, <...> only angle_dirs,
+    // like -iquote and -I
+    IncludeResolver(std::vector<std::string> quote_dirs, std::vector<std::string> angle_dirs) :
+        m_quote_dirs(std::move(quote_dirs)), m_angle_dirs(std::move(angle_dirs)) {}
+
+    // "..." includes are looked up next to the including file first. #include_next
+    // searches the angle directories after the one including_dir lies in
+    std::optional<std::string> resolve(const std::string &including_dir, const Include &include) {
+        if(std::filesystem::path(include.name).is_absolute()) {
+            return find("", include.name);
+        }
+
+        std::size_t first = 0;
+
+        if(include.next) {
+            for(std::size_t i = 0; i < m_angle_dirs.size(); i++) {
+                const auto relative = std::filesystem::path(including_dir).lexically_relative(m_angle_dirs[i]);
+
+                if(!relative.empty() && *relative.begin() != "..") {
+                    first = i + 1;
+                    break;
+                }
+            }
+        }
+
+        if(!include.angled && !include.next) {
+            if(auto path = find(including_dir, include.name)) {
+                return path;
+            }
+
+            for(const auto &dir : m_quote_dirs) {
+                if(auto path = find(dir, include.name)) {
+                    return path;
+                }
+            }
+        }
+
+        for(std::size_t i = first; i < m_angle_dirs.size(); i++) {
+            if(auto path = find(m_angle_dirs[i], include.name)) {
+                return path;
+            }
+        }
+
+        return std::nullopt;
+    }
+};
+
+// Scans a set of files and everything they include, transitively, on a pool of
+// threads. Each file is read and lexed once, however many files include it.
+class DependencyScanner {
+public:
+    struct File {
+        std::string path;
+        bool read = false;
+        // indices into the files of scan(), in include order
+        std::vector<std::size_t> includes;
+        // spelled as in the source, with the delimiters
+        std::vector<std::string> missing;
+    };
+
+private:
+    IncludeResolver &m_resolver;
+    std::size_t m_threads;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::deque<File> m_files;
+    std::unordered_map<std::string, std::size_t> m_index;
+    std::vector<std::size_t> m_queue;
+    std::size_t m_pending = 0;
+
+    // caller holds m_mutex
+    std::size_t add(const std::string &path) {
+        auto [it, added] = m_index.try_emplace(path, m_files.size());
+
+        if(added) {
+            m_files.push_back({path, false, {}, {}});
+            m_queue.push_back(it->second);
+            m_pending++;
+            m_wake.notify_one();
+        }
+
+        return it->second;
+    }
+
+    void work() {
+        Lexer lexer;
+        SourceBuffer source;
+        std::vector<Include> includes;
+        std::vector<std::string> resolved;
+
+        while(true) {
+            std::size_t index;
+            std::string path;
+
+            {
+                std::unique_lock lock(m_mutex);
+                m_wake.wait(lock, [this]() { return !m_queue.empty() || m_pending == 0; });
+
+                if(m_queue.empty()) {
+                    return;
+                }
+
+                index = m_queue.back();
+                m_queue.pop_back();
+                path = m_files[index].path;
+            }
+
+            const bool read = source.open(path.c_str());
+            const std::string dir = std::filesystem::path(path).parent_path().string();
+            std::vector<std::string> missing;
+
+            includes.clear();
+            resolved.clear();
+
+            if(read) {
+                find_includes(lexer, source.view(), includes);
+            }
+
+            for(const auto &include : includes) {
+                if(auto found = m_resolver.resolve(dir, include)) {
+                    resolved.push_back(std::move(*found));
+                } else if(!include.optional) {
+                    missing.push_back((include.angled ? "<" : "\"") + std::string(include.name) + (include.angled ? ">" : "\""));
+                }
+            }
+
+            std::lock_guard lock(m_mutex);
+            File &file = m_files[index];
+            file.read = read;
+            file.missing = std::move(missing);
+
+            // deque elements stay put while add() appends
+            for(const auto &found : resolved) {
+                file.includes.push_back(add(found));
+            }
+
+            if(--m_pending == 0) {
+                m_wake.notify_all();
+            }
+        }
+    }
+
+public:
+    explicit DependencyScanner(IncludeResolver &resolver, std::size_t threads = std::thread::hardware_concurrency()) :
+        m_resolver(resolver), m_threads(std::max<std::size_t>(threads, 1)) {}
+
+    // files[i] is roots[i] for every root, the files they include follow
+    std::vector<File> scan(const std::vector<std::string> &roots) {
+        m_files.clear();
+        m_index.clear();
+        m_queue.clear();
+        m_pending = 0;
+
+        for(const auto &root : roots) {
+            m_files.push_back({root, false, {}, {}});
+            m_index.try_emplace(std::filesystem::path(root).lexically_normal().string(), m_files.size() - 1);
+        }
+
+        for(std::size_t i = roots.size(); i-- > 0;) {
+            m_queue.push_back(i);
+        }
+
+        m_pending = m_queue.size();
+
+        std::vector<std::thread> threads;
+
+        for(std::size_t i = 1; i < m_threads; i++) {
+            threads.emplace_back(&DependencyScanner::work, this);
+        }
+
+        work();
+
+        for(auto &thread : threads) {
+            thread.join();
+        }
+
+        return {std::make_move_iterator(m_files.begin()), std::make_move_iterator(m_files.end())};
+    }
+
+    // everything root includes directly or indirectly, depth first in include order
+    static std::vector<std::size_t> closure(const std::vector<File> &files, std::size_t root) {
+        std::vector<bool> seen(files.size());
+        std::vector<std::size_t> order;
+        std::vector<std::pair<std::size_t, std::size_t>> stack{{root, 0}};
+        seen[root] = true;
+
+        while(!stack.empty()) {
+            auto &[file, next] = stack.back();
+
+            if(next == files[file].includes.size()) {
+                stack.pop_back();
+                continue;
+            }
+
+            const std::size_t included = files[file].includes[next++];
+
+            if(!seen[included]) {
+                seen[included] = true;
+                order.push_back(included);
+                stack.push_back({included, 0});
+            }
+        }
+
+        return order;
+    }
+};
+
+}
+
+#endif
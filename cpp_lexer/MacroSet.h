@@ -0,0 +1,535 @@
+#ifndef CPP_MACRO_SET_H
+#define CPP_MACRO_SET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "lexer/CharClass.h"
+#include "lexer/NumberValue.h"
+
+namespace cpp_lexer {
+
+// Macros a lexer evaluates #if, #ifdef and friends with. A closed set knows
+// every macro, a name it does not have is undefined like it is for a compiler.
+// An open set only knows what it was told, other names make a condition
+// unknown and the lexer keeps all of its branches.
+class MacroSet {
+public:
+    struct Macro {
+        std::string value;
+        // function-like macros are defined, but have no value a condition can use
+        bool function_like = false;
+    };
+
+private:
+    struct Hash {
+        using is_transparent = void;
+
+        std::size_t operator()(std::string_view str) const {
+            return std::hash<std::string_view>()(str);
+        }
+    };
+
+    // nullopt marks a name known to be undefined
+    std::unordered_map<std::string, std::optional<Macro>, Hash, std::equal_to<>> m_macros;
+    const MacroSet *m_fallback = nullptr;
+    bool m_closed = true;
+
+public:
+    // names this set does not know are looked up in fallback, which decides whether
+    // the set is closed
+    void set_fallback(const MacroSet *fallback) {
+        m_fallback = fallback;
+    }
+
+    void clear() {
+        m_macros.clear();
+    }
+
+    void set_closed(bool closed) {
+        m_closed = closed;
+    }
+
+    [[nodiscard]] bool closed() const {
+        return m_closed;
+    }
+
+    void define(std::string_view name, std::string_view value = "1", bool function_like = false) {
+        m_macros.insert_or_assign(std::string(name), Macro{std::string(value), function_like});
+    }
+
+    void undefine(std::string_view name) {
+        m_macros.insert_or_assign(std::string(name), std::nullopt);
+    }
+
+    // NAME, NAME=VALUE or NAME(ARGS)=VALUE, like the -D option of a compiler
+    void define_option(std::string_view option) {
+        const std::size_t equals = option.find('=');
+        std::string_view name = option.substr(0, equals);
+        const std::string_view value = equals == std::string_view::npos ? "1" : option.substr(equals + 1);
+        const std::size_t paren = name.find('(');
+
+        define(name.substr(0, paren), value, paren != std::string_view::npos);
+    }
+
+    // equal for sets with the same macros, fallback and closedness, whatever order
+    // they were defined in. Stable between runs, TokenCache keys entries with it
+    [[nodiscard]] std::uint64_t stamp() const {
+        auto hash = [](std::uint64_t h, std::string_view str) {
+            for(char c : str) {
+                h = (h ^ static_cast<unsigned char>(c)) * 0x100000001b3;
+            }
+
+            return (h ^ 0xff) * 0x100000001b3;
+        };
+
+        std::uint64_t sum = 0;
+
+        for(const auto &[name, macro] : m_macros) {
+            std::uint64_t h = hash(0xcbf29ce484222325, name);
+            h = macro ? hash(hash(h, macro->value), macro->function_like ? "()" : "") : hash(h, "#undef");
+            sum += h ^ h >> 29;
+        }
+
+        return hash(sum ^ (m_fallback ? m_fallback->stamp() : m_closed), "");
+    }
+
+    // nullopt if the set is open and does not know name
+    [[nodiscard]] std::optional<bool> defined(std::string_view name) const {
+        auto it = m_macros.find(name);
+
+        if(it == m_macros.end()) {
+            return m_fallback ? m_fallback->defined(name) : m_closed ? std::optional<bool>(false) : std::nullopt;
+        }
+
+        return it->second.has_value();
+    }
+
+    // nullptr if name is undefined or unknown
+    [[nodiscard]] const Macro *find(std::string_view name) const {
+        auto it = m_macros.find(name);
+
+        if(it == m_macros.end()) {
+            return m_fallback ? m_fallback->find(name) : nullptr;
+        }
+
+        return it->second ? &*it->second : nullptr;
+    }
+};
+
+// The #define and #undef lines of one run, over the MacroSet the lexer was given.
+// Names and values point into the input, so it must not outlive the run. The
+// table takes its memory from Allocator_T, the allocator of the run's vectors.
+template<typename Allocator_T = std::allocator<char>>
+class MacroOverlay {
+public:
+    struct Macro {
+        std::string_view value;
+        bool function_like = false;
+    };
+
+private:
+    using entry_allocator = typename std::allocator_traits<Allocator_T>::template rebind_alloc<std::pair<const std::string_view, std::optional<Macro>>>;
+
+    // nullopt marks a name #undef'd in the input
+    std::unordered_map<std::string_view, std::optional<Macro>, std::hash<std::string_view>, std::equal_to<>, entry_allocator> m_macros;
+    const MacroSet *m_fallback = nullptr;
+
+public:
+    explicit MacroOverlay(const Allocator_T &allocator = Allocator_T()) : m_macros(entry_allocator(allocator)) {}
+
+    // without a fallback every name the input does not define is undefined
+    void set_fallback(const MacroSet *fallback) {
+        m_fallback = fallback;
+    }
+
+    void define(std::string_view name, std::string_view value, bool function_like) {
+        m_macros.insert_or_assign(name, Macro{value, function_like});
+    }
+
+    void undefine(std::string_view name) {
+        m_macros.insert_or_assign(name, std::nullopt);
+    }
+
+    [[nodiscard]] std::optional<bool> defined(std::string_view name) const {
+        auto it = m_macros.find(name);
+
+        if(it == m_macros.end()) {
+            return m_fallback ? m_fallback->defined(name) : std::optional<bool>(false);
+        }
+
+        return it->second.has_value();
+    }
+
+    // nullopt if name is undefined or unknown
+    [[nodiscard]] std::optional<Macro> find(std::string_view name) const {
+        auto it = m_macros.find(name);
+
+        if(it != m_macros.end()) {
+            return it->second;
+        }
+
+        if(const MacroSet::Macro *macro = m_fallback ? m_fallback->find(name) : nullptr) {
+            return Macro{macro->value, macro->function_like};
+        }
+
+        return std::nullopt;
+    }
+};
+
+// Evaluates the expression of an #if or #elif. Object-like macros are expanded
+// by evaluating their value as an expression of its own, which covers the
+// usual numbers, flags and (A && B) definitions but not macros that only make
+// sense pasted into their surroundings. Macros_T is a MacroSet or a MacroOverlay.
+template<typename Macros_T = MacroSet>
+class ConditionEvaluator {
+    struct Value {
+        std::int64_t value;
+        bool known;
+    };
+
+    static constexpr Value unknown{0, false};
+    static constexpr int max_depth = 32;
+
+    std::string_view m_text;
+    std::size_t m_pos = 0;
+    const Macros_T &m_macros;
+    int m_depth;
+    bool m_error = false;
+
+    [[nodiscard]] char peek(std::size_t ahead = 0) const {
+        return m_pos + ahead < m_text.size() ? m_text[m_pos + ahead] : '\0';
+    }
+
+    void skip_space() {
+        while(m_pos < m_text.size()) {
+            if(char_class::is(peek(), char_class::space) || (peek() == '\\' && (peek(1) == '\n' || peek(1) == '\r'))) {
+                m_pos++;
+            } else if(peek() == '/' && peek(1) == '*') {
+                const std::size_t close = m_text.find("*/", m_pos + 2);
+                m_pos = close == std::string_view::npos ? m_text.size() : close + 2;
+            } else if(peek() == '/' && peek(1) == '/') {
+                m_pos = m_text.size();
+            } else {
+                return;
+            }
+        }
+    }
+
+    std::string_view peek_operator() {
+        static constexpr std::string_view operators[] = {"||", "&&", "==", "!=", "<=", ">=", "<<", ">>", "|", "&", "^", "<", ">", "+", "-", "*", "/", "%", "!", "~", "?", ":", "(", ")"};
+
+        skip_space();
+        const std::string_view rest = m_text.substr(m_pos);
+
+        for(std::string_view op : operators) {
+            if(rest.starts_with(op)) {
+                return op;
+            }
+        }
+
+        return {};
+    }
+
+    bool accept(std::string_view op) {
+        if(peek_operator() == op) {
+            m_pos += op.size();
+            return true;
+        }
+
+        return false;
+    }
+
+    std::string_view read_identifier() {
+        skip_space();
+        const std::size_t begin = m_pos;
+
+        while(char_class::is(peek(), char_class::ident_continue | char_class::dollar)) {
+            m_pos++;
+        }
+
+        return m_text.substr(begin, m_pos - begin);
+    }
+
+    // a call or argument list, skipped whole
+    void skip_parens() {
+        int depth = 0;
+
+        do {
+            if(accept("(")) {
+                depth++;
+            } else if(accept(")")) {
+                depth--;
+            } else if(m_pos < m_text.size()) {
+                m_pos++;
+            } else {
+                m_error = true;
+                return;
+            }
+        } while(depth > 0);
+    }
+
+    static int precedence(std::string_view op) {
+        static constexpr std::pair<std::string_view, int> table[] = {
+            {"||", 1}, {"&&", 2}, {"|", 3}, {"^", 4}, {"&", 5}, {"==", 6}, {"!=", 6}, {"<", 7}, {">", 7}, {"<=", 7}, {">=", 7},
+            {"<<", 8}, {">>", 8}, {"+", 9}, {"-", 9}, {"*", 10}, {"/", 10}, {"%", 10},
+        };
+
+        for(const auto &[name, value] : table) {
+            if(name == op) {
+                return value;
+            }
+        }
+
+        return 0;
+    }
+
+    static Value apply(std::string_view op, Value a, Value b) {
+        // either side decides these on its own
+        if(op == "||") {
+            return (a.known && a.value) || (b.known && b.value) ? Value{1, true} : a.known && b.known ? Value{0, true} : unknown;
+        } else if(op == "&&") {
+            return (a.known && !a.value) || (b.known && !b.value) ? Value{0, true} : a.known && b.known ? Value{1, true} : unknown;
+        }
+
+        if(!a.known || !b.known) {
+            return unknown;
+        }
+
+        // wrapping arithmetic, a compiler would warn about the overflow
+        const auto x = static_cast<std::uint64_t>(a.value);
+        const auto y = static_cast<std::uint64_t>(b.value);
+
+        switch(op[0]) {
+        case '|':
+            return {static_cast<std::int64_t>(x | y), true};
+        case '^':
+            return {static_cast<std::int64_t>(x ^ y), true};
+        case '&':
+            return {static_cast<std::int64_t>(x & y), true};
+        case '=':
+            return {a.value == b.value, true};
+        case '!':
+            return {a.value != b.value, true};
+        case '<':
+            if(op == "<<") {
+                return b.value >= 0 && b.value < 64 ? Value{static_cast<std::int64_t>(x << b.value), true} : unknown;
+            }
+
+            return {op == "<" ? a.value < b.value : a.value <= b.value, true};
+        case '>':
+            if(op == ">>") {
+                return b.value >= 0 && b.value < 64 ? Value{a.value >> b.value, true} : unknown;
+            }
+
+            return {op == ">" ? a.value > b.value : a.value >= b.value, true};
+        case '+':
+            return {static_cast<std::int64_t>(x + y), true};
+        case '-':
+            return {static_cast<std::int64_t>(x - y), true};
+        case '*':
+            return {static_cast<std::int64_t>(x * y), true};
+        default:
+            if(b.value == 0 || (b.value == -1 && a.value == std::numeric_limits<std::int64_t>::min())) {
+                return unknown;
+            }
+
+            return {op == "/" ? a.value / b.value : a.value % b.value, true};
+        }
+    }
+
+    Value parse_number() {
+        const std::size_t begin = m_pos;
+
+        while(char_class::is(peek(), char_class::ident_continue) || peek() == '\'' || peek() == '.') {
+            m_pos++;
+        }
+
+        std::string_view digits = m_text.substr(begin, m_pos - begin);
+
+        while(!digits.empty() && (digits.back() == 'u' || digits.back() == 'U' || digits.back() == 'l' || digits.back() == 'L' || digits.back() == 'z' || digits.back() == 'Z')) {
+            digits.remove_suffix(1);
+        }
+
+        int base = 10;
+
+        if(digits.size() > 1 && digits[0] == '0' && (digits[1] == 'x' || digits[1] == 'X' || digits[1] == 'b' || digits[1] == 'B')) {
+            base = digits[1] == 'x' || digits[1] == 'X' ? 16 : 2;
+            digits.remove_prefix(2);
+        } else if(digits.size() > 1 && digits[0] == '0') {
+            base = 8;
+        }
+
+        const NumberValue number = decode_number(digits, base, false);
+
+        if(number.type != NumberValue::Type::integer) {
+            m_error = true;
+            return unknown;
+        }
+
+        return {static_cast<std::int64_t>(number.integer), true};
+    }
+
+    Value parse_identifier() {
+        const std::string_view name = read_identifier();
+
+        if(name == "defined") {
+            const bool paren = accept("(");
+            const std::string_view macro = read_identifier();
+
+            if(macro.empty() || (paren && !accept(")"))) {
+                m_error = true;
+                return unknown;
+            }
+
+            const auto defined = m_macros.defined(macro);
+            return defined ? Value{*defined, true} : unknown;
+        }
+
+        if(name == "true" || name == "false") {
+            return {name == "true", true};
+        }
+
+        const auto macro = m_macros.find(name);
+
+        // calls: function-like macros, __has_include, __has_cpp_attribute and the like
+        if(!macro || macro->function_like) {
+            if(peek_operator() == "(") {
+                skip_parens();
+                return unknown;
+            }
+
+            if(macro) {
+                return unknown;
+            }
+
+            const auto defined = m_macros.defined(name);
+            return defined ? Value{0, true} : unknown;
+        }
+
+        if(m_depth >= max_depth) {
+            return unknown;
+        }
+
+        return ConditionEvaluator(macro->value, m_macros, m_depth + 1).evaluate_value();
+    }
+
+    Value parse_primary() {
+        skip_space();
+
+        if(accept("(")) {
+            const Value value = parse_conditional();
+
+            if(!accept(")")) {
+                m_error = true;
+            }
+
+            return value;
+        }
+
+        if(char_class::is(peek(), char_class::digit)) {
+            return parse_number();
+        }
+
+        if(char_class::is(peek(), char_class::ident_start | char_class::dollar)) {
+            return parse_identifier();
+        }
+
+        // character literals and anything else
+        m_error = true;
+        return unknown;
+    }
+
+    Value parse_unary() {
+        static constexpr std::string_view operators[] = {"!", "~", "-", "+"};
+
+        for(std::string_view op : operators) {
+            if(accept(op)) {
+                const Value value = parse_unary();
+
+                if(!value.known) {
+                    return unknown;
+                }
+
+                switch(op[0]) {
+                case '!':
+                    return {!value.value, true};
+                case '~':
+                    return {~value.value, true};
+                case '-':
+                    return {static_cast<std::int64_t>(0 - static_cast<std::uint64_t>(value.value)), true};
+                default:
+                    return value;
+                }
+            }
+        }
+
+        return parse_primary();
+    }
+
+    Value parse_binary(int min_precedence) {
+        Value left = parse_unary();
+
+        while(!m_error) {
+            const std::string_view op = peek_operator();
+            const int op_precedence = precedence(op);
+
+            if(op_precedence == 0 || op_precedence < min_precedence) {
+                break;
+            }
+
+            m_pos += op.size();
+            left = apply(op, left, parse_binary(op_precedence + 1));
+        }
+
+        return left;
+    }
+
+    Value parse_conditional() {
+        const Value condition = parse_binary(1);
+
+        if(!accept("?")) {
+            return condition;
+        }
+
+        const Value a = parse_conditional();
+
+        if(!accept(":")) {
+            m_error = true;
+            return unknown;
+        }
+
+        const Value b = parse_conditional();
+        return condition.known ? (condition.value ? a : b) : unknown;
+    }
+
+    ConditionEvaluator(std::string_view text, const Macros_T &macros, int depth) :
+        m_text(text), m_macros(macros), m_depth(depth) {}
+
+    Value evaluate_value() {
+        const Value value = parse_conditional();
+        skip_space();
+        return m_error || m_pos != m_text.size() ? unknown : value;
+    }
+
+public:
+    ConditionEvaluator(std::string_view text, const Macros_T &macros) :
+        ConditionEvaluator(text, macros, 0) {}
+
+    // nullopt when the value depends on something unknown or the expression is malformed
+    std::optional<bool> evaluate() {
+        const Value value = evaluate_value();
+        return value.known ? std::optional<bool>(value.value != 0) : std::nullopt;
+    }
+};
+
+}
+
+#endif
@@ -1,8 +1,27 @@
 #ifndef LEXER_H
 #define LEXER_H
 
-#include "lexer/BaseLexer.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
+#include "lexer/BaseLexer.h"
+#include "lexer/BracketIndex.h"
+#include "lexer/CharClass.h"
+#include "lexer/Interner.h"
+#include "lexer/KeywordTable.h"
+#include "lexer/NumberValue.h"
+#include "lexer/OperatorTable.h"
+#include "lexer/StringValue.h"
+#include "MacroSet.h"
 
 namespace cpp_lexer {
 using namespace std::literals;
@@ -62,6 +81,98 @@ struct Token {
         pipe,
         pipe_pipe,
         pipe_equal,
+        lshift_equal,
+        rshift_equal,
+        arrow_star,
+        ellipsis,
+        spaceship,
+
+        kw_alignas,
+        kw_alignof,
+        kw_asm,
+        kw_auto,
+        kw_bool,
+        kw_break,
+        kw_case,
+        kw_catch,
+        kw_char,
+        kw_char8_t,
+        kw_char16_t,
+        kw_char32_t,
+        kw_class,
+        kw_concept,
+        kw_const,
+        kw_consteval,
+        kw_constexpr,
+        kw_constinit,
+        kw_const_cast,
+        kw_continue,
+        kw_co_await,
+        kw_co_return,
+        kw_co_yield,
+        kw_decltype,
+        kw_default,
+        kw_delete,
+        kw_do,
+        kw_double,
+        kw_dynamic_cast,
+        kw_else,
+        kw_enum,
+        kw_explicit,
+        kw_export,
+        kw_extern,
+        kw_false,
+        kw_float,
+        kw_for,
+        kw_friend,
+        kw_goto,
+        kw_if,
+        kw_inline,
+        kw_int,
+        kw_long,
+        kw_mutable,
+        kw_namespace,
+        kw_new,
+        kw_noexcept,
+        kw_nullptr,
+        kw_operator,
+        kw_private,
+        kw_protected,
+        kw_public,
+        kw_register,
+        kw_reinterpret_cast,
+        kw_requires,
+        kw_return,
+        kw_short,
+        kw_signed,
+        kw_sizeof,
+        kw_static,
+        kw_static_assert,
+        kw_static_cast,
+        kw_struct,
+        kw_switch,
+        kw_template,
+        kw_this,
+        kw_thread_local,
+        kw_throw,
+        kw_true,
+        kw_try,
+        kw_typedef,
+        kw_typeid,
+        kw_typename,
+        kw_union,
+        kw_unsigned,
+        kw_using,
+        kw_virtual,
+        kw_void,
+        kw_volatile,
+        kw_wchar_t,
+        kw_while,
+        // only produced in directive mode
+        hash,
+        hash_hash,
+        header_name,
+        directive_end,
 
         _MAX_VALUE
     };
@@ -72,9 +183,9 @@ struct Token {
     static constexpr std::size_t max_index_v = static_cast<std::size_t>(Kind::_MAX_VALUE) - 1;
 
     Kind value;
-    std::string text;
-    int line;
-    int col;
+    // set for identifiers and numbers when the lexer has an interner
+    std::uint32_t symbol = Interner::no_symbol;
+    std::string_view text;
     std::size_t begin;
     std::size_t end;
 
@@ -82,303 +193,1151 @@ struct Token {
         return static_cast<std::size_t>(k);
     }
 
-    static constexpr const char *tokenKinds[] = {"invalid", "identifier", "number", "string", "character", "equal", "equal_equal", "minus", "minus_minus", "minus_equal", "plus", "plus_plus", "plus_equal", "star", "start_equal", "slash", "slash_equal", "caret", "caret_equal", "lparen", "rparen", "lbrace", "rbrace", "lbracket", "rbracket", "semicolon", "colon", "colon_colon", "bang", "bang_equal", "comma", "lt", "gt", "lte", "gte", "lshift", "rshift", "ampersand", "ampersand_ampersand", "ampersand_equal", "dot", "dot_star", "arrow", "comment", "macro", "question", "percent", "percent_equal", "tilde", "tilde_equal", "pipe", "pipe_pipe", "pipe_equal"};
+    static constexpr const char *tokenKinds[] = {"invalid", "identifier", "number", "string", "character", "equal", "equal_equal", "minus", "minus_minus", "minus_equal", "plus", "plus_plus", "plus_equal", "star", "start_equal", "slash", "slash_equal", "caret", "caret_equal", "lparen", "rparen", "lbrace", "rbrace", "lbracket", "rbracket", "semicolon", "colon", "colon_colon", "bang", "bang_equal", "comma", "lt", "gt", "lte", "gte", "lshift", "rshift", "ampersand", "ampersand_ampersand", "ampersand_equal", "dot", "dot_star", "arrow", "comment", "macro", "question", "percent", "percent_equal", "tilde", "tilde_equal", "pipe", "pipe_pipe", "pipe_equal", "lshift_equal", "rshift_equal", "arrow_star", "ellipsis", "spaceship", "kw_alignas", "kw_alignof", "kw_asm", "kw_auto", "kw_bool", "kw_break", "kw_case", "kw_catch", "kw_char", "kw_char8_t", "kw_char16_t", "kw_char32_t", "kw_class", "kw_concept", "kw_const", "kw_consteval", "kw_constexpr", "kw_constinit", "kw_const_cast", "kw_continue", "kw_co_await", "kw_co_return", "kw_co_yield", "kw_decltype", "kw_default", "kw_delete", "kw_do", "kw_double", "kw_dynamic_cast", "kw_else", "kw_enum", "kw_explicit", "kw_export", "kw_extern", "kw_false", "kw_float", "kw_for", "kw_friend", "kw_goto", "kw_if", "kw_inline", "kw_int", "kw_long", "kw_mutable", "kw_namespace", "kw_new", "kw_noexcept", "kw_nullptr", "kw_operator", "kw_private", "kw_protected", "kw_public", "kw_register", "kw_reinterpret_cast", "kw_requires", "kw_return", "kw_short", "kw_signed", "kw_sizeof", "kw_static", "kw_static_assert", "kw_static_cast", "kw_struct", "kw_switch", "kw_template", "kw_this", "kw_thread_local", "kw_throw", "kw_true", "kw_try", "kw_typedef", "kw_typeid", "kw_typename", "kw_union", "kw_unsigned", "kw_using", "kw_virtual", "kw_void", "kw_volatile", "kw_wchar_t", "kw_while", "hash", "hash_hash", "header_name", "directive_end"};
 
     static constexpr const char *name(Kind k) {
         return tokenKinds[index(k)];
     }
+
+    // longest match wins; "//" and "/*" only mark where comments start
+    static constexpr auto operator_list = std::to_array<Operator<Kind>>({
+        {"=", Kind::equal},
+        {"==", Kind::equal_equal},
+        {"-", Kind::minus},
+        {"--", Kind::minus_minus},
+        {"-=", Kind::minus_equal},
+        {"+", Kind::plus},
+        {"++", Kind::plus_plus},
+        {"+=", Kind::plus_equal},
+        {"*", Kind::star},
+        {"*=", Kind::start_equal},
+        {"/", Kind::slash},
+        {"/=", Kind::slash_equal},
+        {"^", Kind::caret},
+        {"^=", Kind::caret_equal},
+        {"(", Kind::lparen},
+        {")", Kind::rparen},
+        {"[", Kind::lbrace},
+        {"]", Kind::rbrace},
+        {"{", Kind::lbracket},
+        {"}", Kind::rbracket},
+        {";", Kind::semicolon},
+        {":", Kind::colon},
+        {"::", Kind::colon_colon},
+        {"!", Kind::bang},
+        {"!=", Kind::bang_equal},
+        {",", Kind::comma},
+        {"<", Kind::lt},
+        {">", Kind::gt},
+        {"<=", Kind::lte},
+        {">=", Kind::gte},
+        {"<<", Kind::lshift},
+        {">>", Kind::rshift},
+        {"&", Kind::ampersand},
+        {"&&", Kind::ampersand_ampersand},
+        {"&=", Kind::ampersand_equal},
+        {".", Kind::dot},
+        {".*", Kind::dot_star},
+        {"->", Kind::arrow},
+        {"?", Kind::question},
+        {"%", Kind::percent},
+        {"%=", Kind::percent_equal},
+        {"~", Kind::tilde},
+        {"~=", Kind::tilde_equal},
+        {"|", Kind::pipe},
+        {"||", Kind::pipe_pipe},
+        {"|=", Kind::pipe_equal},
+        {"<<=", Kind::lshift_equal},
+        {">>=", Kind::rshift_equal},
+        {"->*", Kind::arrow_star},
+        {"...", Kind::ellipsis},
+        {"<=>", Kind::spaceship},
+        {"//", Kind::comment},
+        {"/*", Kind::comment},
+    });
+
+    static constexpr OperatorTable<Kind, operator_list.size()> operators{operator_list};
+
+    // in the same order as the kw_ kinds
+    static constexpr std::array<std::string_view, 81> keywords = {"alignas", "alignof", "asm", "auto", "bool", "break", "case", "catch", "char", "char8_t", "char16_t", "char32_t", "class", "concept", "const", "consteval", "constexpr", "constinit", "const_cast", "continue", "co_await", "co_return", "co_yield", "decltype", "default", "delete", "do", "double", "dynamic_cast", "else", "enum", "explicit", "export", "extern", "false", "float", "for", "friend", "goto", "if", "inline", "int", "long", "mutable", "namespace", "new", "noexcept", "nullptr", "operator", "private", "protected", "public", "register", "reinterpret_cast", "requires", "return", "short", "signed", "sizeof", "static", "static_assert", "static_cast", "struct", "switch", "template", "this", "thread_local", "throw", "true", "try", "typedef", "typeid", "typename", "union", "unsigned", "using", "virtual", "void", "volatile", "wchar_t", "while"};
+
+    static constexpr KeywordTable<keywords.size()> keyword_table{keywords};
+
+    static constexpr Kind identifier_kind(std::string_view text) {
+        const int keyword = keyword_table.find(text);
+        return keyword < 0 ? Kind::identifier : static_cast<Kind>(index(Kind::kw_alignas) + keyword);
+    }
 };
 
-class Lexer : public BaseLexer<Token> {
+static_assert(Token::operators.ok());
+static_assert(Token::keyword_table.ok());
+static_assert(Token::keyword_table.find("reinterpret_cast") >= 0 && Token::keyword_table.find("co_await") >= 0 && Token::keyword_table.find("char16_") < 0);
+static_assert(std::string_view(Token::name(Token::identifier_kind("while"))) == "kw_while");
+
+static_assert(std::is_trivially_copyable_v<Token>);
+
+template<typename Allocator_T = std::allocator<Token>>
+class BasicLexer : public BaseLexer<Token, Allocator_T> {
+    using Base = BaseLexer<Token, Allocator_T>;
+
+    using Base::add_error;
+    using Base::advance;
+    using Base::allocator;
+    using Base::begin_offset;
+    using Base::check;
+    using Base::consume;
+    using Base::done;
+    using Base::end;
+    using Base::get_string_view;
+    using Base::match;
+    using Base::match_operator;
+    using Base::ok;
+    using Base::peek;
+    using Base::recover;
+    using Base::recovering;
+    using Base::reset;
+    using Base::rewind;
+    using Base::skip_identifier;
+    using Base::skip_until;
+    using Base::skip_whitespace;
+    using Base::take_token;
+    using Base::token_count;
+
+    // where a header name in angle brackets may come next, in directive mode
+    enum class HeaderState : std::uint8_t {
+        none,
+        after_hash,
+        has_include,
+        expected,
+    };
+
+    // how far an #if group has got
+    enum class Condition : std::uint8_t {
+        // every branch so far was false
+        searching,
+        // a true branch was taken, the rest are inactive
+        taken,
+        // a branch could not be evaluated, the rest are lexed unless one is false
+        unknown,
+    };
+
+    // what eat_number found out about the literal, offsets into its text
+    struct NumberShape {
+        std::uint8_t base;
+        bool floating;
+        std::uint8_t prefix;
+        std::uint8_t suffix_flags;
+        std::size_t suffix;
+    };
+
+    // where the contents of a string or character literal lie in its text
+    struct LiteralShape {
+        std::size_t body_begin;
+        std::size_t body_end;
+        bool escaped;
+    };
+
+    Interner::Cache m_symbols;
+    BracketIndex *m_brackets = nullptr;
+    NumberValues *m_numbers = nullptr;
+    NumberShape m_number{};
+    StringValues *m_strings = nullptr;
+    LiteralShape m_literal{};
+    const MacroSet *m_predefined = nullptr;
+    template<typename T>
+    using rebind_alloc = typename std::allocator_traits<Allocator_T>::template rebind_alloc<T>;
+
+    struct RunMacros {
+        MacroOverlay<rebind_alloc<char>> macros;
+        std::vector<Condition, rebind_alloc<Condition>> conditions;
+
+        explicit RunMacros(const Allocator_T &allocator) : macros(rebind_alloc<char>(allocator)), conditions(rebind_alloc<Condition>(allocator)) {}
+    };
+
+    // the #define, #undef and #if nesting of the current run, built by every run
+    // with the allocator of its vectors. A copy of the lexer starts without them
+    class RunState {
+        std::optional<RunMacros> m_macros;
+
+    public:
+        RunState() = default;
+
+        RunState(const RunState &) {}
+
+        RunState &operator=(const RunState &) {
+            return *this;
+        }
+
+        void start(const Allocator_T &allocator) {
+            m_macros.emplace(allocator);
+        }
+
+        RunMacros *operator->() {
+            return &*m_macros;
+        }
+
+        const RunMacros *operator->() const {
+            return &*m_macros;
+        }
+    };
+
+    RunState m_run;
+    // skip_inactive() already applied the directive at the current line
+    bool m_resume = false;
+    bool m_directives = false;
+    bool m_skip_comments = false;
+    bool m_skip_macros = false;
+    bool m_in_directive = false;
+    HeaderState m_header_state = HeaderState::none;
+
 public:
-    void lex(const std::string &str, std::vector<Token> &tokens, std::vector<Error> &errors) {
-        BaseLexer::lex(str, tokens, errors);
+    using typename Base::Error;
+    using typename Base::token_vector;
+    using typename Base::error_vector;
 
-        while(!end() && ok()) {
-            reset();
+    // bump whenever the tokens produced for some input change, it invalidates TokenCache entries
+    static constexpr std::uint32_t version = 4;
 
-            const char c = consume();
-            bool handled = true;
+    // with a set of predefined macros, #if, #ifdef, #ifndef, #elif, #else and #endif
+    // are followed and inactive regions skipped without making tokens. #define and
+    // #undef of the input are kept on top of the set, which is not changed. Conditions
+    // that cannot be evaluated keep their code. nullptr lexes everything, it has no
+    // effect in directive mode and ParallelLexer and IncrementalLexer do not support it
+    void set_macros(const MacroSet *macros) {
+        m_predefined = macros;
+    }
 
-            switch(c) {
-            case '=':
-                if(match('=')) {
-                    make_token(Token::Kind::equal_equal);
-                } else {
-                    make_token(Token::Kind::equal);
+    // identifier and number tokens get symbols from interner, which may be shared
+    // with lexers on other threads. nullptr turns interning off
+    void set_interner(Interner *interner) {
+        m_symbols = interner ? Interner::Cache(*interner) : Interner::Cache();
+    }
+
+    // (), [] and {} are matched into brackets while lexing, it is cleared at the start
+    // and complete once lexing ends. Token indices count from the first token of
+    // the run. nullptr turns matching off, ParallelLexer does not support it
+    void set_bracket_index(BracketIndex *brackets) {
+        m_brackets = brackets;
+    }
+
+    // number tokens are decoded into numbers while lexing, it is cleared at the start.
+    // Token indices count from the first token of the run. nullptr turns decoding
+    // off, ParallelLexer does not support it
+    void set_number_values(NumberValues *numbers) {
+        m_numbers = numbers;
+    }
+
+    // string and character literals get their contents, escapes decoded, in strings
+    // while lexing, it is cleared at the start. Token indices count from the first
+    // token of the run. nullptr turns it off, ParallelLexer does not support it
+    void set_string_values(StringValues *strings) {
+        m_strings = strings;
+    }
+
+    // skipped comments are still lexed but never become tokens
+    void set_skip_comments(bool skip) {
+        m_skip_comments = skip;
+    }
+
+    // skips whole preprocessor lines, has no effect in directive mode
+    void set_skip_macros(bool skip) {
+        m_skip_macros = skip;
+    }
+
+    // in directive mode a preprocessor directive is lexed as hash, its tokens and
+    // directive_end instead of one macro token, and the header of an include or
+    // __has_include in angle brackets becomes a header_name. The lexer then has
+    // state between tokens, so it cannot be used with ParallelLexer or
+    // IncrementalLexer
+    void set_directive_mode(bool directives) {
+        m_directives = directives;
+    }
+
+    [[nodiscard]] bool directive_mode() const {
+        return m_directives;
+    }
+
+    // how far a comment, string or macro line cut off by the end of a chunk got, so
+    // StreamLexer can scan on from there instead of going over the token again
+    struct Continuation {
+        enum class Kind : std::uint8_t {
+            none,
+            block_comment,
+            // a line comment or macro, it ends before a newline without a backslash
+            line,
+            string,
+            raw_string,
+        };
+
+        Kind kind = Kind::none;
+        char quote = 0;
+        // the last character was a backslash, or a '*' in a block comment
+        bool pending = false;
+        std::size_t body_begin = 0;
+        // )delimiter" of a raw string
+        std::string terminator;
+    };
+
+    // the state at the end of text, which starts at a token, if that token is a
+    // comment, string or macro that does not end in text. Kind::none otherwise
+    static Continuation continuation(std::string_view text) {
+        using Kind = Continuation::Kind;
+        Continuation c;
+
+        if(text.starts_with("/*")) {
+            c.kind = Kind::block_comment;
+            c.body_begin = 2;
+        } else if(text.starts_with("//") || text.starts_with('#')) {
+            c.kind = Kind::line;
+            c.body_begin = text[0] == '#' ? 1 : 2;
+        } else {
+            const std::size_t quote = text.find_first_of("\"'");
+
+            if(quote == std::string_view::npos || quote > 3) {
+                return {};
+            }
+
+            const std::string_view prefix = text.substr(0, quote);
+            const bool raw = prefix.ends_with('R');
+            const std::string_view encoding = raw ? prefix.substr(0, prefix.size() - 1) : prefix;
+
+            if((raw && text[quote] != '"') || !(encoding.empty() || encoding == "u8" || encoding == "u" || encoding == "U" || encoding == "L")) {
+                return {};
+            }
+
+            if(raw) {
+                const std::size_t open = text.find('(', quote + 1);
+                const std::string_view delimiter = text.substr(quote + 1, open - quote - 1);
+
+                // an unfinished or invalid delimiter is short, the token is lexed again
+                if(open == std::string_view::npos || delimiter.size() > 16 || delimiter.find_first_of(")\\\" \t\v\f\r\n") != std::string_view::npos) {
+                    return {};
                 }
 
-                break;
-            case '+':
-                if(match('+')) {
-                    make_token(Token::Kind::plus_plus);
-                } else if(match('=')) {
-                    make_token(Token::Kind::plus_equal);
+                c.kind = Kind::raw_string;
+                c.terminator.append(")").append(delimiter).append("\"");
+                c.body_begin = open + 1;
+            } else {
+                c.kind = Kind::string;
+                c.quote = text[quote];
+                c.body_begin = quote + 1;
+            }
+        }
+
+        if(continue_token(c, text, c.body_begin) != std::string_view::npos) {
+            return {};
+        }
+
+        return c;
+    }
+
+    // scans text from offset from on, text holding the whole token so far. Returns
+    // the end of the token, or npos and c updated for the next call if it goes on
+    static std::size_t continue_token(Continuation &c, std::string_view text, std::size_t from) {
+        using Kind = Continuation::Kind;
+
+        switch(c.kind) {
+        case Kind::block_comment:
+            for(std::size_t i = from; i < text.size(); i++) {
+                if(!c.pending) {
+                    i = text.find('*', i);
+
+                    if(i == std::string_view::npos) {
+                        break;
+                    }
+
+                    c.pending = true;
+                } else if(text[i] == '/') {
+                    return i + 1;
                 } else {
-                    make_token(Token::Kind::plus);
+                    c.pending = text[i] == '*';
                 }
+            }
 
-                break;
-            case '^':
-                if(match('=')) {
-                    make_token(Token::Kind::caret_equal);
-                } else {
-                    make_token(Token::Kind::caret);
+            break;
+        case Kind::line:
+            for(std::size_t i = from; i < text.size(); i++) {
+                if(std::exchange(c.pending, false) && text[i] == '\n') {
+                    continue;
                 }
 
+                i = text.find_first_of("\n\\", i);
+
+                if(i == std::string_view::npos) {
+                    break;
+                } else if(text[i] == '\n') {
+                    return i;
+                }
+
+                c.pending = true;
+            }
+
+            break;
+        case Kind::string: {
+            const char stop[] = {c.quote, '\\', 0};
+
+            for(std::size_t i = from; i < text.size(); i++) {
+                if(std::exchange(c.pending, false)) {
+                    continue;
+                }
+
+                i = text.find_first_of(stop, i);
+
+                if(i == std::string_view::npos) {
+                    break;
+                } else if(text[i] == c.quote) {
+                    return i + 1;
+                }
+
+                c.pending = true;
+            }
+
+            break;
+        }
+        case Kind::raw_string: {
+            // the terminator may have begun in the text scanned before
+            const std::size_t back = c.terminator.size() - 1;
+            const std::size_t i = text.find(c.terminator, std::max(c.body_begin, from > back ? from - back : 0));
+
+            return i == std::string_view::npos ? i : i + c.terminator.size();
+        }
+        case Kind::none:
+            break;
+        }
+
+        return std::string_view::npos;
+    }
+
+    // without macros, directive mode or side tables the state between tokens is only
+    // the position, so the input can be cut between two tokens and the pieces lexed
+    // apart, as ParallelLexer does
+    [[nodiscard]] bool splittable() const {
+        return !m_predefined && !m_directives && !m_brackets && !m_numbers && !m_strings;
+    }
+
+    // differs between configurations that can make different tokens for the same
+    // input, TokenCache keys its entries with it. Symbols and side tables are not
+    // part of it
+    [[nodiscard]] std::uint64_t cache_stamp() const {
+        std::uint64_t stamp = static_cast<std::uint64_t>(version) << 8 | this->error_recovery() | m_directives << 1 | m_skip_comments << 2 | m_skip_macros << 3 | (m_predefined != nullptr) << 4;
+
+        if(m_predefined) {
+            stamp = stamp * 0x100000001b3 ^ m_predefined->stamp();
+        }
+
+        return stamp;
+    }
+
+    // gives the identifier and number tokens of tokens, made without this lexer,
+    // their symbols. Does nothing without an interner
+    template<typename Tokens_T>
+    void intern_symbols(Tokens_T &tokens) {
+        if(!m_symbols.interner()) {
+            return;
+        }
+
+        for(auto &token : tokens) {
+            if(token.value == Token::Kind::identifier || token.value == Token::Kind::number) {
+                token.symbol = m_symbols.intern(token.text);
+            }
+        }
+    }
+
+    void lex(std::string_view str, token_vector &tokens, error_vector &errors) {
+        Base::lex(str, tokens, errors);
+        begin_run();
+        run();
+    }
+
+    void lex(std::string_view str, TokenBuffer<Token> &tokens, error_vector &errors) {
+        Base::lex(str, tokens, errors);
+        begin_run();
+        run();
+    }
+
+    // lexes the tokens that start in [begin, limit), the last one may run past limit
+    void lex(std::string_view str, std::size_t begin, std::size_t limit, token_vector &tokens, error_vector &errors) {
+        Base::lex(str, begin, limit, tokens, errors);
+        begin_run();
+        run();
+    }
+
+    void start(std::string_view str, error_vector &errors) {
+        Base::start(str, errors);
+        begin_run();
+    }
+
+    void start(std::string_view str, std::size_t begin, std::size_t limit, error_vector &errors) {
+        Base::start(str, begin, limit, errors);
+        begin_run();
+    }
+
+    void run() {
+        while(!done() && ok()) {
+            lex_token();
+        }
+
+        end_run();
+    }
+
+    // lexes on demand, returns false once the input is exhausted or an error stopped the lexer
+    bool next_token(Token &token) {
+        while(!done() && ok()) {
+            lex_token();
+
+            if(take_token(token)) {
+                return true;
+            }
+        }
+
+        end_run();
+        return false;
+    }
+
+    void begin_run() {
+        leave_directive();
+
+        if(m_brackets) {
+            m_brackets->clear();
+        }
+
+        if(m_numbers) {
+            m_numbers->clear();
+        }
+
+        if(m_strings) {
+            m_strings->clear();
+        }
+
+        m_run.start(allocator());
+        m_run->macros.set_fallback(m_predefined);
+        m_resume = false;
+    }
+
+    void end_run() {
+        if(m_brackets) {
+            m_brackets->finish(token_count());
+        }
+    }
+
+    using Base::make_token;
+
+    void make_token(Token::Kind kind) {
+        Base::make_token(kind);
+
+        if(m_brackets) [[unlikely]] {
+            const std::size_t index = token_count() - 1;
+
+            switch(kind) {
+            case Token::Kind::lparen:
+                m_brackets->open(index, 0);
                 break;
-            case '(':
-                make_token(Token::Kind::lparen);
-                break;
-            case ')':
-                make_token(Token::Kind::rparen);
+            case Token::Kind::lbracket:
+                m_brackets->open(index, 1);
                 break;
-            case '[':
-                make_token(Token::Kind::lbrace);
+            case Token::Kind::lbrace:
+                m_brackets->open(index, 2);
                 break;
-            case ']':
-                make_token(Token::Kind::rbrace);
+            case Token::Kind::rparen:
+                m_brackets->close(index, 0);
                 break;
-            case '{':
-                make_token(Token::Kind::lbracket);
+            case Token::Kind::rbracket:
+                m_brackets->close(index, 1);
                 break;
-            case '}':
-                make_token(Token::Kind::rbracket);
+            case Token::Kind::rbrace:
+                m_brackets->close(index, 2);
                 break;
-            case ';':
-                make_token(Token::Kind::semicolon);
+            default:
                 break;
-            case '!':
-                if(match('=')) {
-                    make_token(Token::Kind::bang_equal);
-                } else {
-                    make_token(Token::Kind::bang);
-                }
+            }
+        }
+    }
 
-                break;
-            case ',':
-                make_token(Token::Kind::comma);
-                break;
-            case '&':
-                if(match('=')) {
-                    make_token(Token::Kind::ampersand_equal);
-                } else if(match('&')) {
-                    make_token(Token::Kind::ampersand_ampersand);
-                } else {
-                    make_token(Token::Kind::ampersand);
-                }
+    void lex_token() {
+        if(m_in_directive) {
+            lex_directive_token();
+        } else {
+            lex_any_token();
+        }
+    }
 
-                break;
-            case '?':
-                make_token(Token::Kind::question);
-                break;
-            case '%':
-                if(match('=')) {
-                    make_token(Token::Kind::percent_equal);
-                } else {
-                    make_token(Token::Kind::percent);
-                }
+    void leave_directive() {
+        m_in_directive = false;
+        m_header_state = HeaderState::none;
+    }
 
-                break;
-            case '~':
-                if(match('=')) {
-                    make_token(Token::Kind::tilde_equal);
-                } else {
-                    make_token(Token::Kind::tilde);
-                }
+    void lex_directive_token() {
+        reset();
 
-                break;
-            case '|':
-                if(match('=')) {
-                    make_token(Token::Kind::pipe_equal);
-                } else if(match('|')) {
-                    make_token(Token::Kind::pipe_pipe);
-                } else {
-                    make_token(Token::Kind::pipe);
-                }
+        const char c = peek();
 
-                break;
-            case '\\':
-                break;
-            case '/':
-                if(match('/')) {
-                    if(eat_comment()) {
-                        make_token(Token::Kind::comment);
-                    } else {
-                        handled = false;
-                    }
-                } else if(match('*')) {
-                    if(eat_multiline_comment()) {
-                        make_token(Token::Kind::comment);
-                    } else {
-                        handled = false;
-                    }
-                } else {
-                    make_token(Token::Kind::slash);
-                }
+        if(c == '\n') {
+            advance();
+            leave_directive();
+            make_token(Token::Kind::directive_end);
+        } else if(char_class::is(c, char_class::space)) {
+            skip_until([](const BlockMasks &m) { return ~m.whitespace | m.newline; });
+        } else if(c == '\\') {
+            advance();
+            match('\r');
+            match('\n');
+        } else if(c == '#') {
+            advance();
+            make_token(match('#') ? Token::Kind::hash_hash : Token::Kind::hash);
+            m_header_state = HeaderState::none;
+        } else if(c == '<' && m_header_state == HeaderState::expected && eat_header_name()) {
+            make_token(Token::Kind::header_name);
+            m_header_state = HeaderState::none;
+        } else {
+            lex_any_token();
 
-                break;
-            case '-':
-                if(match('-')) {
-                    make_token(Token::Kind::minus_minus);
-                } else if(match('=')) {
-                    make_token(Token::Kind::minus_equal);
-                } else if(match('>')) {
-                    make_token(Token::Kind::arrow);
-                } else {
-                    make_token(Token::Kind::minus);
-                }
+            const std::string_view text = get_string_view();
 
-                break;
-            case '.':
-                if(match('*')) {
-                    make_token(Token::Kind::dot_star);
-                } else if(!std::isdigit(peek())) {
-                    make_token(Token::Kind::dot);
-                }
+            if(text.starts_with("//") || text.starts_with("/*")) {
+                return;
+            } else if(m_header_state == HeaderState::after_hash && (text == "include" || text == "import" || text == "include_next")) {
+                m_header_state = HeaderState::expected;
+            } else if(text == "__has_include" || text == "__has_include_next") {
+                m_header_state = HeaderState::has_include;
+            } else if(m_header_state == HeaderState::has_include && text == "(") {
+                m_header_state = HeaderState::expected;
+            } else {
+                m_header_state = HeaderState::none;
+            }
+        }
+    }
 
-                break;
-            case '<':
-                if(match('=')) {
-                    make_token(Token::Kind::lte);
-                } else {
-                    make_token(Token::Kind::lt);
-                }
+    // <...> on one line, otherwise the '<' is lexed as an operator
+    bool eat_header_name() {
+        advance();
 
-                break;
-            case '>':
-                if(match('=')) {
-                    make_token(Token::Kind::gte);
+        while(!end() && peek() != '>' && peek() != '\n') {
+            advance();
+        }
+
+        if(match('>')) {
+            return true;
+        }
+
+        rewind(begin_offset());
+        return false;
+    }
+
+    void lex_any_token() {
+        reset();
+
+        const char c = peek();
+        Token::Kind kind;
+
+        if(char_class::is(c, char_class::space)) {
+            skip_whitespace();
+        } else if(char_class::is(c, char_class::ident_start | char_class::dollar)) {
+            if(eat_identifier()) {
+                kind = Token::identifier_kind(get_string_view());
+
+                if(check('"', '\'') && literal_prefix()) {
+                    lex_prefixed_literal();
+                } else if(kind == Token::Kind::identifier) {
+                    make_symbol_token(kind);
                 } else {
-                    make_token(Token::Kind::gt);
+                    make_token(kind);
                 }
+            }
+        } else if(char_class::is(c, char_class::digit)) {
+            advance();
 
-                break;
-            case ':':
-                if(match(':')) {
-                    make_token(Token::Kind::colon_colon);
-                } else {
-                    make_token(Token::Kind::colon);
+            if(eat_number()) {
+                make_number_token();
+            }
+        } else if(c == '"' || c == '\'') {
+            advance();
+            m_literal = {1, 0, false};
+
+            if(eat_string(c)) {
+                make_literal_token(c == '"' ? Token::Kind::string : Token::Kind::character);
+            }
+        } else if(match_operator(Token::operators, kind)) {
+            if(kind == Token::Kind::comment) {
+                if((get_string_view()[1] == '/' ? eat_comment() : eat_multiline_comment()) && !m_skip_comments) {
+                    make_token(Token::Kind::comment);
+                }
+            } else if(kind == Token::Kind::dot && char_class::is(peek(), char_class::digit)) {
+                if(eat_number()) {
+                    make_number_token();
                 }
+            } else {
+                make_token(kind);
+            }
+        } else if(c == '#') {
+            advance();
 
-                break;
-            case '#':
-                if(eat_macro()) {
+            if(m_directives) {
+                m_in_directive = true;
+                m_header_state = HeaderState::after_hash;
+                make_token(Token::Kind::hash);
+            } else if(eat_macro()) {
+                const bool active = !m_predefined || std::exchange(m_resume, false) || apply_directive(get_string_view());
+
+                if(!m_skip_macros) {
                     make_token(Token::Kind::macro);
-                } else {
-                    handled = false;
                 }
 
-                break;
-            case '*':
-                if(match('=')) {
-                    make_token(Token::Kind::start_equal);
-                } else {
-                    make_token(Token::Kind::star);
+                if(!active) {
+                    skip_inactive();
                 }
+            }
+        } else if(c == '\\') {
+            // a line continuation outside of a macro
+            advance();
+        } else {
+            advance();
 
-                break;
-            default:
-                handled = false;
+            // keep a multi-byte UTF-8 character together
+            while((static_cast<unsigned char>(peek()) & 0xC0) == 0x80) {
+                advance();
             }
 
-            if(!handled) {
-                if(std::isspace(c)) {
+            add_error(ErrorCode::unhandled_character);
+            recover(Token::Kind::invalid);
+        }
+    }
 
-                } else if(c == '_' || c == '$' || std::isalpha(c)) {
-                    if(eat_identifier()) {
-                        make_token(Token::Kind::identifier);
-                    }
-                } else if(c == '.' || std::isdigit(c)) {
-                    if(eat_number()) {
-                        make_token(Token::Kind::number);
-                    }
-                } else if(c == '"') {
-                    if(eat_string(c)) {
-                        make_token(Token::Kind::string);
-                    }
-                } else if(c == '\'') {
-                    if(eat_string(c)) {
-                        make_token(Token::Kind::character);
-                    }
-                } else {
-                    add_error("unhandled character \""s + c + "\"\n", line(), col());
-                    fail(true);
-                }
+    void make_symbol_token(Token::Kind kind) {
+        if(m_symbols.interner()) {
+            make_token(kind, m_symbols.intern(get_string_view()));
+        } else {
+            make_token(kind);
+        }
+    }
+
+    // u8, u, U or L before a literal, followed by R for a raw string
+    bool literal_prefix() {
+        const std::string_view prefix = get_string_view();
+        const bool raw = prefix.ends_with('R');
+        const std::string_view encoding = raw ? prefix.substr(0, prefix.size() - 1) : prefix;
+
+        return (!raw || check('"')) && (encoding.empty() || encoding == "u8" || encoding == "u" || encoding == "U" || encoding == "L");
+    }
+
+    void lex_prefixed_literal() {
+        const bool raw = get_string_view().ends_with('R');
+        const char quote = consume();
+        m_literal = {get_string_view().size(), 0, false};
+
+        if(raw ? eat_raw_string() : eat_string(quote)) {
+            make_literal_token(quote == '"' ? Token::Kind::string : Token::Kind::character);
+        }
+    }
+
+    void make_literal_token(Token::Kind kind) {
+        make_token(kind);
+
+        if(m_strings) {
+            const std::string_view body = get_string_view().substr(m_literal.body_begin, m_literal.body_end - m_literal.body_begin);
+
+            if(m_literal.escaped) {
+                m_strings->add_decoded(token_count() - 1, body);
+            } else {
+                m_strings->add(token_count() - 1, body);
             }
         }
     }
 
-    bool eat_identifier() {
-        while(check('_') || check('$') || std::isalnum(peek())) {
-            advance();
+    void make_number_token() {
+        make_symbol_token(Token::Kind::number);
+
+        if(m_numbers) {
+            const std::string_view text = get_string_view();
+            NumberValue value = decode_number(text.substr(m_number.prefix, m_number.suffix - m_number.prefix), m_number.base, m_number.floating);
+            value.suffix = m_number.suffix_flags;
+            m_numbers->add(token_count() - 1, value);
         }
+    }
+
+    // an unterminated string or comment runs to the end of the input, in recovery
+    // mode it is cut at the end of its first line so the rest is still lexed
+    void unterminated(ErrorCode code) {
+        if(recovering()) {
+            const std::size_t line_end = get_string_view().find('\n');
 
+            if(line_end != std::string_view::npos) {
+                rewind(begin_offset() + line_end);
+            }
+        }
+
+        add_error(code);
+        recover(Token::Kind::invalid);
+    }
+
+    bool eat_identifier() {
+        skip_identifier();
         return true;
     }
 
+    // the first character, a digit or a '.' before one, is already consumed
     bool eat_number() {
-        while(!end() && std::isdigit(peek())) {
-            advance();
-        }
+        const char first = get_string_view()[0];
+        char largest = first;
+        m_number = {10, first == '.', 0, 0, 0};
+
+        if(first == '0' && match('x', 'X')) {
+            m_number.base = 16;
+            m_number.prefix = 2;
+            bool digits = eat_digits(char_class::hex_digit, false, largest);
+
+            if(match('.')) {
+                m_number.floating = true;
+                digits = eat_digits(char_class::hex_digit, false, largest) || digits;
+            }
+
+            // a hexadecimal fraction needs an exponent, or the f of a suffix would be a digit
+            if(!digits || (m_number.floating && !check('p', 'P'))) {
+                return invalid_number();
+            }
+
+            if(check('p', 'P') && !eat_exponent()) {
+                return false;
+            }
+        } else if(first == '0' && match('b', 'B')) {
+            m_number.base = 2;
+            m_number.prefix = 2;
+            largest = '0';
+
+            if(!eat_digits(char_class::digit, false, largest) || largest > '1') {
+                return invalid_number();
+            }
+        } else {
+            eat_digits(char_class::digit, first != '.', largest);
 
-        bool fp = false;
+            if(first != '.' && match('.')) {
+                m_number.floating = true;
+                eat_digits(char_class::digit, false, largest);
+            }
+
+            if(check('e', 'E') && !eat_exponent()) {
+                return false;
+            }
 
-        if(match('.')) {
-           fp = true;
+            if(first == '0' && !m_number.floating && get_string_view().size() > 1) {
+                m_number.base = 8;
+
+                if(largest > '7') {
+                    return invalid_number();
+                }
+            }
         }
 
-        while(!end() && std::isdigit(peek())) {
-            advance();
+        m_number.suffix = get_string_view().size();
+
+        if(char_class::is(peek(), char_class::ident_start)) {
+            skip_identifier();
+            m_number.suffix_flags = number_suffix_flags(get_string_view().substr(m_number.suffix), m_number.floating);
         }
 
-        if(check('e')) {
-            advance();
-            match('+', '-');
+        return true;
+    }
+
+    // digits of a class, a single ' may separate two of them. after_digit when the
+    // character before was one
+    bool eat_digits(std::uint8_t digit_class, bool after_digit, char &largest) {
+        bool any = false;
+
+        while(true) {
+            const char c = peek();
 
-            if(!std::isdigit(peek())) {
-                add_error("invalid number", line(), col());
-                fail(true);
+            if(char_class::is(c, digit_class)) {
+                largest = std::max(largest, c);
+                any = after_digit = true;
+                advance();
+            } else if(c == '\'' && after_digit && char_class::is(peek(1), digit_class)) {
+                after_digit = false;
+                advance();
             } else {
-                while(!end() && std::isdigit(peek())) {
-                    advance();
-                }
+                return any;
             }
         }
+    }
+
+    // e or p, an optional sign and decimal digits
+    bool eat_exponent() {
+        advance();
+        match('+', '-');
+        m_number.floating = true;
 
-        if(fp) {
-            match('f', 'l', 'F', 'L');
+        char largest = '0';
+
+        if(!eat_digits(char_class::digit, false, largest)) {
+            return invalid_number();
         }
 
-        return ok();
+        return true;
+    }
+
+    bool invalid_number() {
+        add_error(ErrorCode::invalid_number);
+        recover(Token::Kind::invalid);
+        return false;
     }
 
     bool eat_string(char quote) {
-        while(!end() && !check(quote)) {
-            if(peek() == '\\') {
+        while(true) {
+            skip_until([](const BlockMasks &m) { return m.quote | m.backslash; });
+
+            if(end() || check(quote)) {
+                break;
+            }
+
+            if(consume() == '\\' && !end()) {
+                m_literal.escaped = true;
                 advance();
             }
+        }
 
+        if(end()) {
+            unterminated(ErrorCode::unterminated_string);
+            return false;
+        }
+
+        m_literal.body_end = get_string_view().size();
+        advance();
+        return true;
+    }
+
+    // delimiter( ... )delimiter", after the opening quote. Only the closing quote is
+    // searched for, a block at a time, and the text before it checked
+    bool eat_raw_string() {
+        const std::size_t delimiter_begin = get_string_view().size();
+
+        while(!end() && !check('(', ')', '\\', '"') && !char_class::is(peek(), char_class::space)) {
             advance();
         }
 
-        if(end()) {
-            add_error("unterminated string\n", line(), col());
-            fail(true);
-        } else {
+        const std::string_view delimiter = get_string_view().substr(delimiter_begin);
+
+        if(delimiter.size() > 16 || !match('(')) {
+            add_error(ErrorCode::invalid_raw_string);
+            recover(Token::Kind::invalid);
+            return false;
+        }
+
+        m_literal.body_begin = get_string_view().size();
+
+        while(true) {
+            skip_until([](const BlockMasks &m) { return m.quote; });
+
+            if(end()) {
+                unterminated(ErrorCode::unterminated_string);
+                return false;
+            }
+
+            const std::string_view text = get_string_view();
+
+            if(check('"') && text.size() >= m_literal.body_begin + delimiter.size() + 1 && text.ends_with(delimiter) && text[text.size() - delimiter.size() - 1] == ')') {
+                m_literal.body_end = text.size() - delimiter.size() - 1;
+                advance();
+                return true;
+            }
+
             advance();
         }
+    }
 
-        return ok();
+    // the name of the directive on line, rest is what follows it
+    static std::string_view directive_name(std::string_view line, std::string_view &rest) {
+        std::size_t i = line.find('#') + 1;
+
+        while(i < line.size() && (line[i] == ' ' || line[i] == '\t')) {
+            i++;
+        }
+
+        const std::size_t begin = i;
+
+        while(i < line.size() && char_class::is(line[i], char_class::ident_continue)) {
+            i++;
+        }
+
+        rest = line.substr(i);
+        return line.substr(begin, i - begin);
     }
 
-    bool eat_macro() {
-        while(!end() && !check('\n')) {
-            if(match('\\')) {
-                match('\n');
-            } else {
+    // the identifier at the start of text, after blanks
+    static std::string_view leading_identifier(std::string_view text) {
+        std::size_t begin = 0;
+
+        while(begin < text.size() && (text[begin] == ' ' || text[begin] == '\t')) {
+            begin++;
+        }
+
+        std::size_t end = begin;
+
+        while(end < text.size() && char_class::is(text[end], char_class::ident_continue | char_class::dollar)) {
+            end++;
+        }
+
+        return text.substr(begin, end - begin);
+    }
+
+    // the condition of #if, #elif, #ifdef, #ifndef, #elifdef or #elifndef
+    std::optional<bool> evaluate_condition(std::string_view name, std::string_view rest) const {
+        if(name == "if" || name == "elif") {
+            return ConditionEvaluator(rest, m_run->macros).evaluate();
+        }
+
+        const std::string_view macro = leading_identifier(rest);
+        const auto defined = macro.empty() ? std::nullopt : m_run->macros.defined(macro);
+
+        if(!defined) {
+            return std::nullopt;
+        }
+
+        return name.ends_with("ndef") ? !*defined : *defined;
+    }
+
+    // follows a directive line, returns false if the code after it is inactive
+    bool apply_directive(std::string_view line) {
+        std::string_view rest;
+        const std::string_view name = directive_name(line, rest);
+
+        if(name == "if" || name == "ifdef" || name == "ifndef") {
+            const auto value = evaluate_condition(name, rest);
+            m_run->conditions.push_back(!value ? Condition::unknown : *value ? Condition::taken : Condition::searching);
+            return value.value_or(true);
+        } else if(name == "elif" || name == "elifdef" || name == "elifndef") {
+            if(m_run->conditions.empty()) {
+                return true;
+            }
+
+            if(m_run->conditions.back() == Condition::taken) {
+                return false;
+            }
+
+            const auto value = evaluate_condition(name, rest);
+
+            if(value && !*value) {
+                return false;
+            }
+
+            m_run->conditions.back() = value ? Condition::taken : Condition::unknown;
+            return true;
+        } else if(name == "else") {
+            if(m_run->conditions.empty()) {
+                return true;
+            }
+
+            if(m_run->conditions.back() == Condition::taken) {
+                return false;
+            }
+
+            if(m_run->conditions.back() == Condition::searching) {
+                m_run->conditions.back() = Condition::taken;
+            }
+        } else if(name == "endif") {
+            if(!m_run->conditions.empty()) {
+                m_run->conditions.pop_back();
+            }
+        } else if(name == "define") {
+            const std::string_view macro = leading_identifier(rest);
+            const std::string_view after = rest.substr(rest.find(macro) + macro.size());
+
+            if(!macro.empty()) {
+                m_run->macros.define(macro, after.starts_with('(') ? "" : after, after.starts_with('('));
+            }
+        } else if(name == "undef") {
+            const std::string_view macro = leading_identifier(rest);
+
+            if(!macro.empty()) {
+                m_run->macros.undefine(macro);
+            }
+        }
+
+        return true;
+    }
+
+    // skips an inactive region a line at a time, looking only at directives. Stops
+    // at the start of the line of the directive that ends it, which is already
+    // applied, or at the end of the input
+    void skip_inactive() {
+        std::size_t depth = 0;
+
+        while(!end() && ok()) {
+            skip_line();
+            reset();
+
+            while(check(' ', '\t', '\f', '\v')) {
                 advance();
             }
+
+            if(!match('#')) {
+                continue;
+            }
+
+            eat_macro();
+
+            std::string_view rest;
+            const std::string_view name = directive_name(get_string_view(), rest);
+
+            if(name == "if" || name == "ifdef" || name == "ifndef") {
+                depth++;
+            } else if(depth > 0) {
+                depth -= name == "endif";
+            } else if((name == "elif" || name == "elifdef" || name == "elifndef" || name == "else" || name == "endif") && apply_directive(get_string_view())) {
+                rewind(begin_offset());
+                m_resume = true;
+                return;
+            }
+        }
+    }
+
+    // past the end of the current line, and of comments and quotes that could hide it
+    void skip_line() {
+        while(!end()) {
+            skip_until([](const BlockMasks &m) { return m.newline | m.slash | m.quote | m.backslash; });
+
+            if(end()) {
+                return;
+            }
+
+            const char c = consume();
+
+            if(c == '\n') {
+                return;
+            } else if(c == '\\') {
+                match('\r');
+                match('\n');
+            } else if(c == '/' && match('/')) {
+                eat_comment();
+            } else if(c == '/' && match('*')) {
+                // an unterminated comment is left to the compiler, the region ends with the input anyway
+                while(!end()) {
+                    skip_until([](const BlockMasks &m) { return m.star; });
+
+                    if(match('*') && match('/')) {
+                        break;
+                    }
+                }
+            } else if(c == '"' || c == '\'') {
+                // an apostrophe in prose ends at the end of the line
+                while(!end() && !check(c, '\n')) {
+                    if(consume() == '\\' && !end()) {
+                        advance();
+                    }
+                }
+
+                match(c);
+            }
+        }
+    }
+
+    bool eat_macro() {
+        while(true) {
+            skip_until([](const BlockMasks &m) { return m.newline | m.backslash; });
+
+            if(end() || check('\n')) {
+                break;
+            }
+
+            advance();
+            match('\n');
         }
 
         return ok();
@@ -386,38 +1345,48 @@ public:
 
 
     bool eat_comment() {
-        while(!end() && !check('\n')) {
-            if(match('\\')) {
-                match('\n');
-            } else {
-                advance();
+        while(true) {
+            skip_until([](const BlockMasks &m) { return m.newline | m.backslash; });
+
+            if(end() || check('\n')) {
+                break;
             }
+
+            advance();
+            match('\n');
         }
 
         return ok();
     }
 
     bool eat_multiline_comment() {
-        while(!end()) {
-            if(match('*')) {
-                if(check('/')) {
-                    advance();
-                    break;
-                }
-            } else {
+        bool closed = false;
+
+        while(!closed && !end()) {
+            skip_until([](const BlockMasks &m) { return m.star; });
+
+            if(match('*') && check('/')) {
                 advance();
+                closed = true;
             }
         }
 
-        if(end()) {
-            add_error("unterminated comment\n", line(), col());
-            fail(true);
+        if(!closed) {
+            unterminated(ErrorCode::unterminated_comment);
+            return false;
         }
 
-        return ok();
+        return true;
     }
 };
 
+using Lexer = BasicLexer<>;
+
+// all memory of a run, token vector, error vector, any allocator aware token
+// text and the #define and #if state, from the memory_resource of the vectors.
+// Side tables like NumberValues and an Interner keep their own memory.
+using PmrLexer = BasicLexer<std::pmr::polymorphic_allocator<Token>>;
+
 }
 
 #endif
@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "DependencyScanner.h"
+#include "lexer/OutputBuffer.h"
+#include "lexer/SourceFiles.h"
+
+using namespace std::literals;
+using namespace cpp_lexer;
+
+int usage(const char *name) {
+    std::fprintf(stderr, "usage: %s [-I DIR]... [-iquote DIR]... [--threads N] [--format make|json] <file|directory|@list|glob>...\n", name);
+    return 1;
+}
+
+// make escapes spaces and '#', '$' doubles
+void put_make_path(OutputBuffer &out, std::string_view path) {
+    for(char c : path) {
+        if(c == ' ' || c == '#') {
+            out.put('\\');
+        } else if(c == '$') {
+            out.put('$');
+        }
+
+        out.put(c);
+    }
+}
+
+int main(int argc, char **argv) {
+    std::vector<std::string> inputs;
+    std::vector<std::string> quote_dirs;
+    std::vector<std::string> angle_dirs;
+    std::size_t threads = std::thread::hardware_concurrency();
+    bool json = false;
+
+    for(int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+
+        if(arg == "-I" && i + 1 < argc) {
+            angle_dirs.emplace_back(argv[++i]);
+        } else if(arg.starts_with("-I") && arg.size() > 2) {
+            angle_dirs.emplace_back(arg.substr(2));
+        } else if(arg == "-iquote" && i + 1 < argc) {
+            quote_dirs.emplace_back(argv[++i]);
+        } else if(arg == "--threads" && i + 1 < argc) {
+            threads = std::strtoul(argv[++i], nullptr, 10);
+        } else if(arg == "--format" && i + 1 < argc && (argv[i + 1] == "make"sv || argv[i + 1] == "json"sv)) {
+            json = argv[++i] == "json"sv;
+        } else if(arg.starts_with("-")) {
+            return usage(argv[0]);
+        } else {
+            inputs.emplace_back(arg);
+        }
+    }
+
+    if(inputs.empty()) {
+        return usage(argv[0]);
+    }
+
+    std::vector<std::string> roots;
+    bool ok = true;
+
+    for(const auto &input : inputs) {
+        if(!collect_sources(input, roots)) {
+            std::fprintf(stderr, "failed to read %s\n", input.c_str());
+            ok = false;
+        }
+    }
+
+    std::sort(roots.begin(), roots.end());
+    roots.erase(std::unique(roots.begin(), roots.end()), roots.end());
+
+    IncludeResolver resolver(std::move(quote_dirs), std::move(angle_dirs));
+    DependencyScanner scanner(resolver, threads);
+    const auto files = scanner.scan(roots);
+
+    OutputBuffer out;
+
+    if(json) {
+        out.put("[\n");
+    }
+
+    bool first = true;
+
+    for(std::size_t root = 0; root < roots.size(); root++) {
+        if(!files[root].read) {
+            std::fprintf(stderr, "failed to read %s\n", roots[root].c_str());
+            ok = false;
+            continue;
+        }
+
+        const auto dependencies = DependencyScanner::closure(files, root);
+
+        if(json) {
+            std::vector<std::string_view> missing;
+
+            for(std::size_t file : dependencies) {
+                missing.insert(missing.end(), files[file].missing.begin(), files[file].missing.end());
+            }
+
+            missing.insert(missing.end(), files[root].missing.begin(), files[root].missing.end());
+            std::sort(missing.begin(), missing.end());
+            missing.erase(std::unique(missing.begin(), missing.end()), missing.end());
+
+            out.put(first ? "  {\"file\": " : ",\n  {\"file\": ");
+            put_json_string(out, roots[root]);
+            out.put(", \"dependencies\": [");
+
+            for(std::size_t i = 0; i < dependencies.size(); i++) {
+                out.put(i ? ", " : "");
+                put_json_string(out, files[dependencies[i]].path);
+            }
+
+            out.put("], \"missing\": [");
+
+            for(std::size_t i = 0; i < missing.size(); i++) {
+                out.put(i ? ", " : "");
+                put_json_string(out, missing[i]);
+            }
+
+            out.put("]}");
+        } else {
+            // the object file a compiler with -M would name
+            put_make_path(out, std::filesystem::path(roots[root]).stem().string() + ".o");
+            out.put(':');
+            out.put(' ');
+            put_make_path(out, roots[root]);
+
+            for(std::size_t file : dependencies) {
+                out.put(" \\\n  ");
+                put_make_path(out, files[file].path);
+            }
+
+            out.put('\n');
+        }
+
+        first = false;
+    }
+
+    if(json) {
+        out.put("\n]\n");
+    }
+
+    if(!out.flush()) {
+        std::fprintf(stderr, "failed to write output\n");
+        return 1;
+    }
+
+    return ok ? 0 : 1;
+}
@@ -1,54 +1,383 @@
-#include <cctype>
+#include <algorithm>
 #include <string>
 #include <cstdio>
+#include <cstdlib>
 #include <vector>
-#include <fstream>
 #include <concepts>
+#include <optional>
+#include <thread>
 
 #include "cpp_lexer.h"
+#include "lexer/BatchLexer.h"
+#include "lexer/LineIndex.h"
+#include "lexer/OutputBuffer.h"
+#include "lexer/ParallelLexer.h"
+#include "lexer/SourceBuffer.h"
+#include "lexer/SourceFiles.h"
+#include "lexer/TokenCache.h"
 
 using namespace std::literals;
 using namespace cpp_lexer;
 
-std::string readFile(const char *filename) {
-    std::ifstream f(filename);
+enum class Format {
+    text,
+    jsonl,
+    binary,
+    none,
+};
 
-    if(!f.good()) {
-        return "";
+struct Options {
+    std::size_t threads = 0;
+    bool recover = false;
+    bool skip_comments = false;
+    bool skip_macros = false;
+    // NAME[=VALUE] of -D options
+    std::vector<std::string_view> defines;
+    const char *cache = nullptr;
+    Format format = Format::text;
+    bool format_given = false;
+};
+
+// the original human readable listing
+void write_text(OutputBuffer &out, std::string_view code, const std::vector<Token> &tokens, const std::vector<Lexer::Error> &errors) {
+    LineIndex lines(code);
+    LineIndex::Cursor cursor(lines);
+
+    for(const auto &token : tokens) {
+        auto location = cursor.location(token.begin);
+        out.put("token ");
+        out.put(Token::name(token.value));
+        out.put(": \"");
+        out.put(token.text);
+        out.put("\"\n    line: ");
+        out.put_number(location.line);
+        out.put("\n    col: ");
+        out.put_number(location.col);
+        out.put("\n\n");
     }
 
-    f.seekg(0, std::ios::end);
-    std::size_t size = f.tellg();
-    f.seekg(0, std::ios::beg);
-    std::string str(size, '\0');
-    f.read(str.data(), size);
-    return str;
+    for(const auto &error : errors) {
+        auto location = lines.location(error.begin);
+        out.put("error on line: ");
+        out.put_number(location.line);
+        out.put(", col: ");
+        out.put_number(location.col);
+        out.put(": ");
+        out.put(error.message(code));
+        out.put(" (");
+        out.put(error.text(code));
+        out.put(")\n");
+    }
 }
 
-int main(int, char **argv) {
-    Lexer lexer;
-    std::vector<Token> tokens;
-    std::vector<Lexer::Error> errors;
-    std::string code = readFile(argv[1]);
+// one JSON object per line, tokens then errors
+void write_jsonl(OutputBuffer &out, std::string_view code, const std::vector<Token> &tokens, const std::vector<Lexer::Error> &errors) {
+    LineIndex lines(code);
+    LineIndex::Cursor cursor(lines);
+
+    for(const auto &token : tokens) {
+        auto location = cursor.location(token.begin);
+        out.put("{\"kind\":\"");
+        out.put(Token::name(token.value));
+        out.put("\",\"text\":");
+        put_json_string(out, token.text);
+        out.put(",\"line\":");
+        out.put_number(location.line);
+        out.put(",\"col\":");
+        out.put_number(location.col);
+        out.put(",\"begin\":");
+        out.put_number(token.begin);
+        out.put(",\"end\":");
+        out.put_number(token.end);
+        out.put("}\n");
+    }
 
-    //int total = 0;
+    for(const auto &error : errors) {
+        auto location = lines.location(error.begin);
+        auto message = error.message(code);
+
+        if(message.ends_with('\n')) {
+            message.pop_back();
+        }
+
+        out.put("{\"error\":");
+        put_json_string(out, message);
+        out.put(",\"line\":");
+        out.put_number(location.line);
+        out.put(",\"col\":");
+        out.put_number(location.col);
+        out.put(",\"begin\":");
+        out.put_number(error.begin);
+        out.put(",\"end\":");
+        out.put_number(error.end);
+        out.put("}\n");
+    }
+}
 
-    //for(int i = 0; i < 100000; i++) {
-    //    tokens.clear();
-    //    errors.clear();
-        lexer.lex(code, tokens, errors);
-    //    total += tokens.size();
-    //}
+// header: "CLXT", u32 format version, u32 Lexer::version, u32 Token::max_index_v,
+//         u32 token count, u32 error count
+// tokens: u8 kind, u32 begin, u32 length
+// errors: u8 code, u32 begin, u32 length
+// all packed, in host byte order, so it holds inputs below binary_max_size. A reader
+// checks the lexer version and kind count before mapping kinds back to names.
+constexpr std::size_t binary_max_size = std::size_t(0xFFFFFFFF);
+constexpr std::uint32_t binary_format_version = 2;
 
-    //printf("total tokens: %d\n", total);
+void write_binary(OutputBuffer &out, const std::vector<Token> &tokens, const std::vector<Lexer::Error> &errors) {
+    out.put("CLXT");
+    out.put_raw(binary_format_version);
+    out.put_raw(Lexer::version);
+    out.put_raw(static_cast<std::uint32_t>(Token::max_index_v));
+    out.put_raw(static_cast<std::uint32_t>(tokens.size()));
+    out.put_raw(static_cast<std::uint32_t>(errors.size()));
 
     for(const auto &token : tokens) {
-        std::printf("token %s: \"%s\"\n    line: %d\n    col: %d\n\n", Token::name(token.value), token.text.c_str(), token.line, token.col);
+        out.put_raw(static_cast<std::uint8_t>(Token::index(token.value)));
+        out.put_raw(static_cast<std::uint32_t>(token.begin));
+        out.put_raw(static_cast<std::uint32_t>(token.end - token.begin));
     }
 
     for(const auto &error : errors) {
-        std::printf("error on line: %d, col: %d: %s (%s)\n", error.line, error.col, error.error.c_str(), error.text.c_str());
+        out.put_raw(static_cast<std::uint8_t>(error.code));
+        out.put_raw(static_cast<std::uint32_t>(error.begin));
+        out.put_raw(static_cast<std::uint32_t>(error.end - error.begin));
+    }
+}
+
+int usage(const char *name) {
+    std::fprintf(stderr, "usage: %s [options] [--format text|jsonl|binary|none] <file>\n", name);
+    std::fprintf(stderr, "       %s [options] <file|directory|@list|glob>...\n", name);
+    std::fprintf(stderr, "options: [--threads N] [--recover] [--cache DIR] [--skip-comments] [--skip-macros] [-D NAME[=VALUE]]...\n");
+    std::fprintf(stderr, "with -D, #if branches that the defined macros decide are skipped, others are kept. It cannot be\n");
+    std::fprintf(stderr, "used with --threads on a single file. --format is for a single file, with several inputs or a\n");
+    std::fprintf(stderr, "directory a summary line is printed per file\n");
+    std::fprintf(stderr, "exit status: 0 if every input was lexed without errors, 1 otherwise\n");
+    return 1;
+}
+
+// prints a summary line per file and its errors, in path order
+int lex_batch(const std::vector<std::string> &inputs, const Options &options, const Lexer &configured, const TokenCache<Lexer, Token> *cache) {
+    std::vector<std::string> paths;
+    bool ok = true;
+
+    for(const auto &input : inputs) {
+        if(!collect_sources(input, paths)) {
+            std::fprintf(stderr, "failed to read %s\n", input.c_str());
+            ok = false;
+        }
+    }
+
+    std::sort(paths.begin(), paths.end());
+    paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+
+    BatchLexer<Lexer, Token> lexer(options.threads ? options.threads : std::thread::hardware_concurrency());
+    lexer.set_lexer(configured);
+    lexer.set_cache(cache);
+
+    // formatted on the worker while the file is still open, each slot is written by one thread
+    std::vector<std::string> diagnostics(paths.size());
+
+    auto results = lexer.lex(paths, [&](std::size_t file, std::string_view code, const std::vector<Token> &, const std::vector<Lexer::Error> &errors) {
+        if(errors.empty()) {
+            return;
+        }
+
+        LineIndex lines(code);
+
+        for(const auto &error : errors) {
+            auto location = lines.location(error.begin);
+            auto message = error.message(code);
+
+            if(message.ends_with('\n')) {
+                message.pop_back();
+            }
+
+            diagnostics[file] += paths[file] + ":" + std::to_string(location.line) + ":" + std::to_string(location.col) + ": error: " + message + "\n";
+        }
+    });
+
+    std::size_t files = 0;
+    std::size_t cached = 0;
+    std::size_t bytes = 0;
+    std::size_t tokens = 0;
+    std::size_t errors = 0;
+
+    for(std::size_t i = 0; i < paths.size(); i++) {
+        const auto &result = results[i];
+
+        if(!result.read) {
+            std::fprintf(stderr, "failed to read %s\n", paths[i].c_str());
+            ok = false;
+            continue;
+        }
+
+        std::printf("%s: %zu bytes, %zu tokens, %zu errors\n%s", paths[i].c_str(), result.bytes, result.tokens, result.errors.size(), diagnostics[i].c_str());
+        files++;
+        cached += result.cached;
+        bytes += result.bytes;
+        tokens += result.tokens;
+        errors += result.errors.size();
+    }
+
+    std::printf("total: %zu files, %zu bytes, %zu tokens, %zu errors", files, bytes, tokens, errors);
+
+    if(cache) {
+        std::printf(", %zu cached", cached);
+    }
+
+    std::printf("\n");
+    return ok && errors == 0 ? 0 : 1;
+}
+
+int main(int argc, char **argv) {
+    std::vector<std::string> inputs;
+    Options options;
+
+    for(int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+
+        if(arg == "--threads" && i + 1 < argc) {
+            options.threads = std::strtoul(argv[++i], nullptr, 10);
+        } else if(arg == "--recover") {
+            options.recover = true;
+        } else if(arg == "--skip-comments") {
+            options.skip_comments = true;
+        } else if(arg == "--skip-macros") {
+            options.skip_macros = true;
+        } else if(arg == "-D" && i + 1 < argc) {
+            options.defines.emplace_back(argv[++i]);
+        } else if(arg.starts_with("-D") && arg.size() > 2) {
+            options.defines.push_back(arg.substr(2));
+        } else if(arg == "--cache" && i + 1 < argc) {
+            options.cache = argv[++i];
+        } else if(arg == "--format" && i + 1 < argc) {
+            std::string_view format = argv[++i];
+            options.format_given = true;
+
+            if(format == "text") {
+                options.format = Format::text;
+            } else if(format == "jsonl") {
+                options.format = Format::jsonl;
+            } else if(format == "binary") {
+                options.format = Format::binary;
+            } else if(format == "none") {
+                options.format = Format::none;
+            } else {
+                return usage(argv[0]);
+            }
+        } else if(arg.starts_with("-")) {
+            return usage(argv[0]);
+        } else {
+            inputs.emplace_back(arg);
+        }
+    }
+
+    if(inputs.empty()) {
+        return usage(argv[0]);
+    }
+
+    // an open set, conditions on macros that were not given keep all their branches
+    MacroSet macros;
+    macros.set_closed(false);
+
+    for(std::string_view define : options.defines) {
+        macros.define_option(define);
+    }
+
+    Lexer configured;
+    configured.set_error_recovery(options.recover);
+    configured.set_skip_comments(options.skip_comments);
+    configured.set_skip_macros(options.skip_macros);
+
+    if(!options.defines.empty()) {
+        configured.set_macros(&macros);
+    }
+
+    std::optional<TokenCache<Lexer, Token>> cache;
+
+    if(options.cache) {
+        cache.emplace(options.cache, configured);
+
+        if(!cache->open()) {
+            std::fprintf(stderr, "failed to create cache directory %s\n", options.cache);
+            return 1;
+        }
+    }
+
+    std::vector<std::string> single;
+
+    if(inputs.size() > 1 || !collect_sources(inputs[0], single) || single.size() != 1 || single[0] != inputs[0]) {
+        if(options.format_given) {
+            std::fprintf(stderr, "--format cannot be used with several inputs or a directory\n");
+            return 1;
+        }
+
+        return lex_batch(inputs, options, configured, cache ? &*cache : nullptr);
+    }
+
+    const char *filename = inputs[0].c_str();
+    ParallelLexer<Lexer, Token> parallel(options.threads);
+
+    if(options.threads > 1 && !parallel.set_lexer(configured)) {
+        std::fprintf(stderr, "-D cannot be used with --threads on a single file\n");
+        return 1;
+    }
+
+    auto lex = [&](std::string_view code, std::vector<Token> &tokens, std::vector<Lexer::Error> &errors) {
+        if(options.threads > 1) {
+            parallel.lex(code, tokens, errors);
+        } else {
+            configured.lex(code, tokens, errors);
+        }
+    };
+
+    std::vector<Token> tokens;
+    std::vector<Lexer::Error> errors;
+    SourceBuffer source;
+
+    if(!source.open(filename)) {
+        std::fprintf(stderr, "failed to read %s\n", filename);
+        return 1;
+    }
+
+    std::string_view code = source.view();
+
+    if(options.format == Format::binary && code.size() >= binary_max_size) {
+        std::fprintf(stderr, "%s is too large for the binary format, it holds up to 4 GiB\n", filename);
+        return 1;
+    }
+
+    if(cache) {
+        const std::uint64_t key = cache->key(code);
+
+        if(!cache->load(code, key, tokens, errors)) {
+            lex(code, tokens, errors);
+            cache->store(code, key, tokens, errors);
+        }
+    } else {
+        lex(code, tokens, errors);
+    }
+
+    OutputBuffer out;
+
+    switch(options.format) {
+    case Format::text:
+        write_text(out, code, tokens, errors);
+        break;
+    case Format::jsonl:
+        write_jsonl(out, code, tokens, errors);
+        break;
+    case Format::binary:
+        write_binary(out, tokens, errors);
+        break;
+    case Format::none:
+        break;
+    }
+
+    if(!out.flush()) {
+        std::fprintf(stderr, "failed to write output\n");
+        return 1;
     }
 
-    return 0;
+    return errors.empty() ? 0 : 1;
 }
@@ -0,0 +1,545 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iterator>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "MacroSet.h"
+#include "cpp_lexer.h"
+#include "lexer/BracketIndex.h"
+#include "lexer/IncrementalLexer.h"
+#include "lexer/Interner.h"
+#include "lexer/NumberValue.h"
+#include "lexer/ParallelLexer.h"
+#include "lexer/SourceBuffer.h"
+#include "lexer/StreamLexer.h"
+#include "lexer/StringValue.h"
+#include "lexer/TokenBuffer.h"
+#include "lexer/TokenCache.h"
+#include "lexer/TokenView.h"
+
+// Checks that every way of lexing agrees with a plain Lexer::lex(), on a corpus
+// file and on inputs made to put comments, strings and macros across segment,
+// chunk and edit boundaries. Exits with 1 if any check fails.
+
+using namespace cpp_lexer;
+
+static int g_failures = 0;
+
+void check(const char *name, bool ok) {
+    std::printf("%s %s\n", ok ? "ok    " : "FAILED", name);
+    g_failures += !ok;
+}
+
+struct Lexed {
+    std::vector<Token> tokens;
+    std::vector<Lexer::Error> errors;
+};
+
+Lexed lex(Lexer &lexer, std::string_view code) {
+    Lexed result;
+    lexer.lex(code, result.tokens, result.errors);
+    return result;
+}
+
+Lexed lex(std::string_view code, bool recover = false) {
+    Lexer lexer;
+    lexer.set_error_recovery(recover);
+    return lex(lexer, code);
+}
+
+bool same_tokens(const std::vector<Token> &a, const std::vector<Token> &b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const Token &x, const Token &y) {
+        return x.value == y.value && x.begin == y.begin && x.end == y.end && x.text == y.text;
+    });
+}
+
+bool same_errors(const std::vector<Lexer::Error> &a, const std::vector<Lexer::Error> &b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const auto &x, const auto &y) {
+        return x.code == y.code && x.begin == y.begin && x.end == y.end;
+    });
+}
+
+bool same(const Lexed &a, const Lexed &b) {
+    return same_tokens(a.tokens, b.tokens) && same_errors(a.errors, b.errors);
+}
+
+// comments, strings and continued lines that segment and chunk boundaries fall into
+std::string tricky_input() {
+    std::string tricky;
+
+    for(int i = 0; i < 200; i++) {
+        tricky += "int a = b / c; /* comment\n * \"not a string\n * // not a line comment\n */\n";
+        tricky += "const char *s = \"/* not a comment */ \\\" still string\"; // comment \\\ncontinued\n";
+        tricky += "#define X(a) \\\n    (a * 2) \\\n    + 1\nchar c = '\"'; x->y.z = .5e+3 >>= 1;\n";
+    }
+
+    return tricky;
+}
+
+// a stray character every ~1000 bytes and an unterminated string and comment
+std::string dirty_input(std::string_view code) {
+    std::string dirty;
+
+    for(std::size_t offset = 0; offset < code.size(); offset += 997) {
+        dirty += code.substr(offset, 997);
+        dirty += '@';
+    }
+
+    dirty += "\n1e+ \"abc\nx /* y\nz";
+    return dirty;
+}
+
+void test_pull(std::string_view code) {
+    Lexer lexer;
+    const Lexed expected = lex(lexer, code);
+    Lexed pulled;
+    Token token;
+    lexer.start(code, pulled.errors);
+
+    while(lexer.next_token(token)) {
+        pulled.tokens.push_back(token);
+    }
+
+    check("pull mode matches lex()", same(pulled, expected));
+}
+
+void test_token_buffer(std::string_view code) {
+    Lexer lexer;
+    const Lexed expected = lex(lexer, code);
+    TokenBuffer<Token> buffer;
+    std::vector<Lexer::Error> errors;
+    lexer.lex(code, buffer, errors);
+
+    bool ok = buffer.size() == expected.tokens.size() && same_errors(errors, expected.errors);
+
+    for(std::size_t i = 0; ok && i < buffer.size(); i++) {
+        const Token token = buffer[i];
+        ok = token.value == expected.tokens[i].value && token.begin == expected.tokens[i].begin && token.end == expected.tokens[i].end && token.text == expected.tokens[i].text;
+    }
+
+    TokenBuffer<Token>::Source source(buffer);
+
+    for(std::size_t i = 0; ok && !source.end(); i++) {
+        const auto ref = source.consume();
+        const Token token = ref;
+        ok = ref.value == expected.tokens[i].value && ref.text() == expected.tokens[i].text && token.begin == expected.tokens[i].begin;
+    }
+
+    const auto semicolons = std::count_if(expected.tokens.begin(), expected.tokens.end(), [](const Token &t) { return t.value == Token::Kind::semicolon; });
+    ok = ok && static_cast<std::ptrdiff_t>(buffer.count(Token::Kind::semicolon)) == semicolons;
+
+    check("TokenBuffer matches std::vector<Token>", ok);
+}
+
+// segments are made tiny so that many of them start inside comments, strings and macros
+bool check_parallel(std::string_view code, const Lexer &prototype) {
+    Lexer serial = prototype;
+    const Lexed expected = lex(serial, code);
+
+    for(std::size_t threads : {2, 3, 7, 16}) {
+        for(std::size_t min_segment_size : {1, 61, 4096}) {
+            ParallelLexer<Lexer, Token> lexer(threads, min_segment_size);
+            Lexed result;
+
+            if(!lexer.set_lexer(prototype)) {
+                return false;
+            }
+
+            lexer.lex(code, result.tokens, result.errors);
+
+            if(!same(result, expected)) {
+                std::printf("parallel mismatch with %zu threads, %zu byte segments\n", threads, min_segment_size);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+void test_parallel(std::string_view code) {
+    Lexer plain;
+    Lexer recovering;
+    Lexer skipping;
+    recovering.set_error_recovery(true);
+    skipping.set_skip_comments(true);
+    skipping.set_skip_macros(true);
+
+    const std::string tricky = tricky_input();
+
+    check("parallel matches serial", check_parallel(code, plain) && check_parallel(tricky, plain));
+    check("parallel stops at the first error", !lex(tricky + "@ error").errors.empty() && check_parallel(tricky + "@ error", plain));
+    check("parallel with recovery matches serial", check_parallel(dirty_input(code), recovering));
+    check("parallel skipping trivia matches serial", check_parallel(tricky, skipping));
+
+    MacroSet macros;
+    Lexer conditional;
+    conditional.set_macros(&macros);
+    ParallelLexer<Lexer, Token> parallel;
+    check("parallel refuses a lexer with macros", !parallel.set_lexer(conditional));
+}
+
+// applies pseudo-random edits to source and checks the updated tokens against a full lex after every edit
+bool check_incremental(std::string source, int edits, bool recover) {
+    static constexpr std::string_view inserts[] = {"", "x", " ", "\n", "/", "*", "\"", "'", "\\", "#", "1", ".", "/*", "*/", "//", "\\\n", "@"};
+
+    IncrementalLexer<Lexer, Token> incremental;
+    incremental.set_error_recovery(recover);
+    Lexed lexed = lex(source, recover);
+    std::uint32_t seed = 12345;
+
+    auto random = [&seed]() {
+        seed = seed * 1664525 + 1013904223;
+        return seed >> 8;
+    };
+
+    for(int i = 0; i < edits; i++) {
+        const std::size_t offset = random() % (source.size() + 1);
+        const std::size_t removed = std::min<std::size_t>(random() % 3, source.size() - offset);
+        incremental.apply(source, {offset, removed, inserts[random() % std::size(inserts)]}, lexed.tokens, lexed.errors);
+
+        if(!same(lexed, lex(source, recover))) {
+            std::printf("incremental mismatch after edit %d at offset %zu\n", i, offset);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void test_incremental() {
+    std::string tricky;
+
+    for(int i = 0; i < 20; i++) {
+        tricky += "int a = b / c; /* comment\n * \"not a string\n */\nconst char *s = \"a \\\" b\"; // c \\\nd\n";
+        tricky += "#define X(a) \\\n    (a * 2)\nchar c = '\"'; x->y.z = .5e+3 >>= 1;\n";
+    }
+
+    check("incremental edits match a full lex", check_incremental(tricky, 3000, false));
+    check("incremental edits with recovery match a full lex", check_incremental(tricky, 3000, true));
+}
+
+// lexes code in chunks of chunk_size bytes and checks the result against the whole-buffer tokens
+bool check_stream(std::string_view code, std::size_t chunk_size) {
+    const std::vector<Token> expected = lex(code).tokens;
+    StreamLexer<Lexer, Token> stream;
+    std::vector<Token> chunk_tokens;
+    std::vector<Lexer::Error> errors;
+    std::size_t index = 0;
+
+    auto compare = [&]() {
+        for(const auto &token : chunk_tokens) {
+            if(index >= expected.size() || token.value != expected[index].value || token.begin != expected[index].begin || token.end != expected[index].end || token.text != expected[index].text) {
+                return false;
+            }
+
+            index++;
+        }
+
+        chunk_tokens.clear();
+        return true;
+    };
+
+    for(std::size_t offset = 0; offset < code.size(); offset += chunk_size) {
+        stream.feed(code.substr(offset, chunk_size), chunk_tokens, errors);
+
+        if(!compare()) {
+            return false;
+        }
+    }
+
+    stream.finish(chunk_tokens, errors);
+    return compare() && index == expected.size();
+}
+
+void test_stream(std::string_view code) {
+    const std::string pad(100000, 'x');
+    const std::string long_tokens[] = {
+        "int a; /*" + pad + "**/ int b;",
+        "x \"" + pad + "\\\"\\\\\" y",
+        "x u8R\"ab(" + pad + ")a\" )ab\" z",
+        "#define X " + pad + "\\\n" + pad + "\nint c;",
+        "// " + pad + "\\\n more\nint d;",
+        "a /* unterminated " + pad,
+    };
+
+    bool ok = true;
+
+    for(std::size_t chunk_size : {1, 7, 4096, 65536}) {
+        ok = ok && check_stream(code, chunk_size) && check_stream(tricky_input(), chunk_size);
+    }
+
+    check("stream matches whole-buffer lexing", ok);
+    ok = true;
+
+    for(const auto &input : long_tokens) {
+        ok = ok && check_stream(input, 7) && check_stream(input, 4096);
+    }
+
+    check("stream carries long tokens across chunks", ok);
+}
+
+void test_skip_trivia(std::string_view code) {
+    Lexer skipping;
+    skipping.set_skip_comments(true);
+    skipping.set_skip_macros(true);
+
+    const std::vector<Token> tokens = lex(code).tokens;
+    const std::vector<Token> significant = lex(skipping, code).tokens;
+    auto view = without_kinds(tokens, {Token::Kind::comment, Token::Kind::macro});
+
+    check("skipping trivia matches a filtered view", std::ranges::equal(view, significant, [](const Token &a, const Token &b) { return a.value == b.value && a.begin == b.begin && a.end == b.end; }));
+}
+
+void test_brackets(std::string_view code) {
+    BracketIndex brackets;
+    Lexer matching;
+    matching.set_bracket_index(&brackets);
+    const std::vector<Token> tokens = lex(matching, code).tokens;
+
+    // the same matching done afterwards with a stack
+    std::vector<std::size_t> open;
+    bool ok = true;
+
+    for(std::size_t i = 0; i < tokens.size(); i++) {
+        switch(tokens[i].value) {
+        case Token::Kind::lparen:
+        case Token::Kind::lbracket:
+        case Token::Kind::lbrace:
+            open.push_back(i);
+            break;
+        case Token::Kind::rparen:
+        case Token::Kind::rbracket:
+        case Token::Kind::rbrace:
+            if(!open.empty()) {
+                ok = ok && brackets.match(open.back()) == i && brackets.match(i) == open.back();
+                open.pop_back();
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    check("bracket index matches a rescan", !brackets.balanced() || ok);
+}
+
+void test_numbers() {
+    // a generated table, the kind of input where numbers dominate
+    std::string table = "const unsigned long long table[] = {\n";
+
+    for(std::uint64_t i = 0, x = 88172645463325252ull; i < 3000; i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+
+        char entry[64];
+        std::snprintf(entry, sizeof(entry), i % 3 == 0 ? "0x%llxull, " : i % 3 == 1 ? "%llu, " : "%llu.25e-3, ", static_cast<unsigned long long>(i % 3 == 2 ? x >> 40 : x));
+        table += entry;
+    }
+
+    table += "};\n";
+
+    Lexer decoding;
+    NumberValues numbers;
+    decoding.set_number_values(&numbers);
+    const std::vector<Token> tokens = lex(decoding, table).tokens;
+
+    // the same values converted from the text of every number
+    std::vector<NumberValue> reparsed;
+
+    for(const auto &token : tokens) {
+        if(token.value == Token::Kind::number) {
+            const std::string text(token.text);
+            NumberValue value;
+
+            if(text.find_first_of(".e") != std::string::npos && !text.starts_with("0x")) {
+                value.type = NumberValue::Type::floating;
+                value.floating = std::strtod(text.c_str(), nullptr);
+            } else {
+                value.integer = std::strtoull(text.c_str(), nullptr, 0);
+            }
+
+            reparsed.push_back(value);
+        }
+    }
+
+    bool ok = numbers.size() == reparsed.size();
+
+    for(std::size_t i = 0; ok && i < numbers.size(); i++) {
+        ok = numbers.value(i).type == reparsed[i].type && numbers.value(i).integer == reparsed[i].integer && numbers.value(i).floating == reparsed[i].floating;
+    }
+
+    check("number values match strtoull and strtod", ok);
+}
+
+void test_strings() {
+    std::string table = "const char *messages[] = {\n";
+
+    for(std::size_t i = 0; i < 1000; i++) {
+        table += i % 4 == 0 ? "    \"line\\tnumber \\x41\\n\",\n" : "    \"a message without escapes in it\",\n";
+    }
+
+    table += "    u8R\"x(raw \\n)x\", L'\\''};\n";
+
+    Lexer decoding;
+    StringValues strings;
+    decoding.set_string_values(&strings);
+    const std::vector<Token> tokens = lex(decoding, table).tokens;
+
+    bool ok = strings.size() == 1002 && strings.value(1000) == "raw \\n" && strings.value(1001) == "'";
+
+    for(std::size_t i = 0; ok && i < 1000; i++) {
+        const std::string_view text = tokens[strings.token(i)].text;
+        const std::string_view body = text.substr(1, text.size() - 2);
+        std::string value(body.size(), '\0');
+        value.resize(decode_escapes(body, value.data()));
+        ok = strings.value(i) == value;
+    }
+
+    check("string values match decoding the text", ok);
+}
+
+void test_inactive(std::string_view code) {
+    // a platform conditional header, only the last of three copies is live
+    const std::string header = "#if defined(_WIN32)\n" + std::string(code) + "\n#elif defined(__APPLE__)\n" + std::string(code) + "\n#else\n" + std::string(code) + "\n#endif\n";
+
+    MacroSet macros;
+    macros.define("__linux__");
+    macros.define("__cplusplus", "202002L");
+
+    Lexer skipping;
+    skipping.set_macros(&macros);
+    const std::vector<Token> live = lex(skipping, header).tokens;
+
+    // the live copy on its own, plus the #if, #else and #endif lines
+    const std::vector<Token> expected = lex(skipping, code).tokens;
+
+    check("inactive regions are skipped", live.size() == expected.size() + 3 && std::equal(expected.begin(), expected.end(), live.begin() + 2, [](const Token &a, const Token &b) { return a.value == b.value && a.text == b.text; }));
+
+    // with #define and #undef in the input, and every allocation of the run from an arena
+    const std::string defines = "#define FEATURE 2\n#if FEATURE > 1\nint a;\n#else\nint b;\n#endif\n#undef FEATURE\n#ifdef FEATURE\nint c;\n#endif\n" + header;
+    std::vector<std::byte> storage(defines.size() * 64);
+    std::pmr::monotonic_buffer_resource arena(storage.data(), storage.size(), std::pmr::null_memory_resource());
+
+    PmrLexer pmr;
+    PmrLexer::token_vector pmr_tokens(&arena);
+    PmrLexer::error_vector pmr_errors(&arena);
+    pmr.set_macros(&macros);
+    pmr.lex(defines, pmr_tokens, pmr_errors);
+
+    const std::vector<Token> expected_defines = lex(skipping, defines).tokens;
+    check("PmrLexer skips the same regions with its arena", std::equal(pmr_tokens.begin(), pmr_tokens.end(), expected_defines.begin(), expected_defines.end(), [](const Token &a, const Token &b) { return a.value == b.value && a.begin == b.begin; }));
+}
+
+void test_interner(std::string_view code) {
+    Interner interner;
+    Lexer interning;
+    interning.set_interner(&interner);
+    const std::vector<Token> tokens = lex(interning, code).tokens;
+
+    check("interned symbols name their tokens", std::all_of(tokens.begin(), tokens.end(), [&interner](const Token &token) {
+        const bool symbolic = token.value == Token::Kind::identifier || token.value == Token::Kind::number;
+        return symbolic ? interner.name(token.symbol) == token.text : token.symbol == Interner::no_symbol;
+    }));
+}
+
+void test_cache(std::string_view code) {
+    const auto directory = std::filesystem::temp_directory_path() / ("cpp_lexer_test-" + std::to_string(::getpid()));
+
+    Lexer plain;
+    Lexer skipping;
+    Interner interner;
+    Lexer interning;
+    skipping.set_skip_comments(true);
+    interning.set_interner(&interner);
+
+    TokenCache<Lexer, Token> cache(directory, plain);
+    Lexed first;
+    Lexed second;
+    Lexed skipped;
+    Lexed interned;
+
+    bool ok = cache.open() && !cache.lex(plain, code, first.tokens, first.errors) && cache.lex(plain, code, second.tokens, second.errors) && same(first, second);
+    check("token cache hits return the lexed tokens", ok);
+
+    ok = !cache.lex(skipping, code, skipped.tokens, skipped.errors) && same(skipped, lex(skipping, code));
+    check("token cache is not shared between configurations", ok);
+
+    ok = cache.lex(interning, code, interned.tokens, interned.errors) && std::all_of(interned.tokens.begin(), interned.tokens.end(), [&interner](const Token &token) {
+        return token.value != Token::Kind::identifier || interner.name(token.symbol) == token.text;
+    });
+    check("token cache hits get symbols", ok);
+
+    std::error_code ec;
+    std::filesystem::remove_all(directory, ec);
+}
+
+void test_keywords(std::string_view code) {
+    bool ok = true;
+
+    for(std::size_t i = 0; i < Token::keywords.size(); i++) {
+        ok = ok && Token::index(Token::identifier_kind(Token::keywords[i])) == Token::index(Token::Kind::kw_alignas) + i;
+    }
+
+    for(const auto &token : lex(code).tokens) {
+        if(token.value == Token::Kind::identifier) {
+            ok = ok && std::find(Token::keywords.begin(), Token::keywords.end(), token.text) == Token::keywords.end();
+        }
+    }
+
+    check("keyword hash matches the keyword list", ok);
+}
+
+void test_edges() {
+    const Lexed comment = lex("x /* c */");
+    check("a comment may close at the end of input", comment.errors.empty() && comment.tokens.size() == 2 && comment.tokens[1].text == "/* c */");
+
+    const Lexed string = lex("x \"abc\\");
+    check("a string may end in a backslash", string.errors.size() == 1 && string.errors[0].code == ErrorCode::unterminated_string);
+}
+
+int main(int argc, char **argv) {
+    if(argc < 2) {
+        std::fprintf(stderr, "usage: %s <file>\n", argv[0]);
+        return 1;
+    }
+
+    SourceBuffer source;
+
+    if(!source.open(argv[1])) {
+        std::fprintf(stderr, "failed to read %s\n", argv[1]);
+        return 1;
+    }
+
+    const std::string_view code = source.view();
+
+    test_pull(code);
+    test_token_buffer(code);
+    test_parallel(code);
+    test_incremental();
+    test_stream(code);
+    test_skip_trivia(code);
+    test_brackets(code);
+    test_numbers();
+    test_strings();
+    test_inactive(code);
+    test_interner(code);
+    test_cache(code);
+    test_keywords(code);
+    test_edges();
+
+    if(g_failures) {
+        std::printf("%d checks failed\n", g_failures);
+        return 1;
+    }
+
+    return 0;
+}
@@ -1,37 +1,119 @@
 #ifndef BASE_LEXER_H
 #define BASE_LEXER_H
 
+#include <cstdint>
 #include <cstdlib>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 #include "BaseLexerCore.h"
+#include "TokenBuffer.h"
 
 template<typename T>
 concept LexerToken = requires(T a) {
     { a.value } -> std::convertible_to<typename T::value_type>;
-    { a.text } -> std::convertible_to<std::string>;
-    { a.line } -> std::convertible_to<int>;
-    { a.col } -> std::convertible_to<int>;
+    { a.text } -> std::convertible_to<std::string_view>;
     { a.begin } -> std::convertible_to<std::size_t>;
     { a.end } -> std::convertible_to<std::size_t>;
+};
+
+// tokens that carry line and column numbers make the lexer track them per byte,
+// the others only get offsets
+template<typename T>
+concept LocatedToken = LexerToken<T> && requires(T a) {
+    { a.line } -> std::convertible_to<int>;
+    { a.col } -> std::convertible_to<int>;
     { T{.value = a.value, .text = a.text, .line = a.line, .col = a.col, .begin = a.begin, .end = a.end} };
 };
 
-template<LexerToken Token_T>
-class BaseLexer : public BaseLexerCore {
+// tokens that can carry an interned symbol, see Interner
+template<typename T>
+concept SymbolToken = LexerToken<T> && requires(T a) {
+    { a.symbol } -> std::convertible_to<std::uint32_t>;
+};
+
+template<typename T>
+concept OffsetToken = LexerToken<T> && requires(T a) {
+    { T{.value = a.value, .text = a.text, .begin = a.begin, .end = a.end} };
+};
+
+enum class ErrorCode : std::uint8_t {
+    unhandled_character,
+    invalid_number,
+    unterminated_string,
+    unterminated_comment,
+    input_too_large,
+    invalid_raw_string,
+};
+
+// errors only hold a code and the offending range, the message is built
+// when it is needed from the source the offsets refer to
+struct LexError {
+    ErrorCode code;
+    std::size_t begin;
+    std::size_t end;
+
+    [[nodiscard]] std::string_view text(std::string_view source) const {
+        return source.substr(begin, end - begin);
+    }
+
+    [[nodiscard]] std::string message(std::string_view source) const {
+        switch(code) {
+        case ErrorCode::unhandled_character:
+            return "unhandled character \"" + std::string(text(source)) + "\"\n";
+        case ErrorCode::invalid_number:
+            return "invalid number";
+        case ErrorCode::unterminated_string:
+            return "unterminated string\n";
+        case ErrorCode::unterminated_comment:
+            return "unterminated comment\n";
+        case ErrorCode::input_too_large:
+            return "input too large for a TokenBuffer";
+        case ErrorCode::invalid_raw_string:
+            return "invalid raw string delimiter";
+        }
+
+        return "unknown error";
+    }
+};
+
+// Tokens and errors go into vectors using Allocator_T, rebound for errors, so
+// all memory of a lexing run can come from e.g. a std::pmr arena. Token text
+// that is allocator aware, like std::pmr::string, is built with the allocator
+// of the token vector, or of the error vector in pull mode.
+template<typename Token_T, typename Allocator_T = std::allocator<Token_T>> requires LocatedToken<Token_T> || OffsetToken<Token_T>
+class BaseLexer : public BaseLexerCore<LocatedToken<Token_T>> {
+    using Core = BaseLexerCore<LocatedToken<Token_T>>;
+
 public:
-    struct Error {
-        std::string error;
-        std::string text;
-        int line;
-        int col;
-    };
+    using Error = LexError;
+    using allocator_type = Allocator_T;
+    using token_vector = std::vector<Token_T, Allocator_T>;
+    using error_vector = std::vector<Error, typename std::allocator_traits<Allocator_T>::template rebind_alloc<Error>>;
+
+    // with recovery on, lexing continues past errors instead of stopping at the first one
+    void set_error_recovery(bool recover) {
+        m_recover = recover;
+    }
+
+    [[nodiscard]] bool error_recovery() const {
+        return m_recover;
+    }
 
 private:
-    std::vector<Token_T> *m_tokens;
-    std::vector<Error> *m_errors;
+    using text_type = decltype(Token_T::text);
+
+    token_vector *m_tokens;
+    TokenBuffer<Token_T> *m_buffer;
+    error_vector *m_errors;
+    Token_T m_next{};
+    std::size_t m_token_count = 0;
+    bool m_has_next = false;
     bool m_fail;
+    bool m_recover = false;
 
 protected:
     [[nodiscard]] bool ok() const {
@@ -42,19 +124,135 @@ protected:
         m_fail = x;
     }
 
-    void add_error(std::string str, int line, int col) {
-        m_errors->push_back({str, get_string(), line, col});
+    [[nodiscard]] bool recovering() const {
+        return m_recover;
+    }
+
+    // tokens made since lex() or start()
+    [[nodiscard]] std::size_t token_count() const {
+        return m_token_count;
+    }
+
+    void add_error(ErrorCode code) {
+        m_errors->push_back({code, Core::begin_offset(), Core::end_offset()});
+    }
+
+    // after add_error(): stop, or in recovery mode emit the offending range as an invalid token and go on
+    void recover(typename Token_T::value_type invalid) {
+        if(m_recover) {
+            make_token(invalid);
+        } else {
+            fail(true);
+        }
+    }
+
+    // the allocator of the vectors the current run fills
+    Allocator_T allocator() const {
+        return m_tokens ? m_tokens->get_allocator() : Allocator_T(m_errors->get_allocator());
+    }
+
+    text_type current_text() const {
+        if constexpr(std::uses_allocator_v<text_type, Allocator_T>) {
+            return std::make_obj_using_allocator<text_type>(allocator(), Core::get_string_view());
+        } else {
+            return text_type(Core::get_string_view());
+        }
+    }
+
+    Token_T current_token(typename Token_T::value_type value) const {
+        if constexpr(LocatedToken<Token_T>) {
+            return {.value = value, .text = current_text(), .line = Core::line(), .col = Core::col(), .begin = Core::begin_offset(), .end = Core::end_offset()};
+        } else {
+            return {.value = value, .text = current_text(), .begin = Core::begin_offset(), .end = Core::end_offset()};
+        }
     }
 
     void make_token(typename Token_T::value_type value) {
-        m_tokens->push_back({value, get_string(), line(), col(), begin_offset(), end_offset()});
+        m_token_count++;
+
+        if(m_tokens) [[likely]] {
+            m_tokens->push_back(current_token(value));
+        } else if(m_buffer) {
+            m_buffer->push_back(value, Core::begin_offset(), Core::end_offset());
+        } else {
+            m_next = current_token(value);
+            m_has_next = true;
+        }
+    }
+
+    // a TokenBuffer has no room for symbols, they are dropped there
+    void make_token(typename Token_T::value_type value, std::uint32_t symbol) requires SymbolToken<Token_T> {
+        m_token_count++;
+
+        if(m_tokens) [[likely]] {
+            m_tokens->push_back(current_token(value));
+            m_tokens->back().symbol = symbol;
+        } else if(m_buffer) {
+            m_buffer->push_back(value, Core::begin_offset(), Core::end_offset());
+        } else {
+            m_next = current_token(value);
+            m_next.symbol = symbol;
+            m_has_next = true;
+        }
+    }
+
+    void lex(std::string_view str, token_vector &tokens, error_vector &errors) {
+        lex(str, 0, str.size(), tokens, errors);
     }
 
-    void lex(const std::string &str, std::vector<Token_T> &tokens, std::vector<Error> &errors) {
+    void lex(std::string_view str, std::size_t begin, std::size_t limit, token_vector &tokens, error_vector &errors) {
         m_tokens = &tokens;
+        m_buffer = nullptr;
         m_errors = &errors;
         m_fail = false;
-        BaseLexerCore::lex(str);
+        m_token_count = 0;
+        Core::lex(str, begin, limit);
+    }
+
+    void lex(std::string_view str, TokenBuffer<Token_T> &tokens, error_vector &errors) requires OffsetToken<Token_T> {
+        m_tokens = nullptr;
+        m_buffer = &tokens;
+        m_errors = &errors;
+        m_fail = false;
+        m_token_count = 0;
+
+        if(str.size() <= TokenBuffer<Token_T>::max_size) {
+            tokens.reserve_for(str.size());
+        }
+
+        Core::lex(str);
+        tokens.set_source(str);
+
+        if(str.size() > TokenBuffer<Token_T>::max_size) {
+            Core::reset();
+            add_error(ErrorCode::input_too_large);
+            fail(true);
+        }
+    }
+
+    // pull mode: tokens are held one at a time and handed out by take_token()
+    void start(std::string_view str, error_vector &errors) {
+        start(str, 0, str.size(), errors);
+    }
+
+    void start(std::string_view str, std::size_t begin, std::size_t limit, error_vector &errors) {
+        m_tokens = nullptr;
+        m_buffer = nullptr;
+        m_errors = &errors;
+        m_has_next = false;
+        m_fail = false;
+        m_token_count = 0;
+        Core::lex(str, begin, limit);
+    }
+
+    bool take_token(Token_T &token) {
+        if(!m_has_next) {
+            return false;
+        }
+
+        token = std::move(m_next);
+        m_has_next = false;
+        return true;
     }
 };
 
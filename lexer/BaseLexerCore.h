@@ -1,6 +1,8 @@
 #ifndef BASE_LEXER_CORE_H
 #define BASE_LEXER_CORE_H
 
+#include <bit>
+#include <cstdint>
 #include <cstdlib>
 #include <string>
 #include <string_view>
@@ -8,11 +10,18 @@
 
 #include <cstdio>
 
+#include "BlockClassifier.h"
+#include "CharClass.h"
+
+// With TrackLines = false only byte offsets are maintained, line and column
+// numbers can be recovered afterwards from a LineIndex.
+template<bool TrackLines = true>
 class BaseLexerCore {
     std::string_view m_str;
     const char *m_current;
     const char *m_start;
     const char *m_end;
+    const char *m_limit;
     int m_line;
     int m_col;
     int m_line_start;
@@ -23,11 +32,15 @@ protected:
         return std::string(m_start, m_current - m_start);
     }
 
-    [[nodiscard]] int line() const {
+    [[nodiscard]] std::string_view get_string_view() const {
+        return std::string_view(m_start, m_current - m_start);
+    }
+
+    [[nodiscard]] int line() const requires TrackLines {
         return m_line_start;
     }
 
-    [[nodiscard]] int col() const {
+    [[nodiscard]] int col() const requires TrackLines {
         return m_col_start;
     }
 
@@ -41,24 +54,101 @@ protected:
 
     void reset() {
         m_start = m_current;
-        m_line_start = m_line;
-        m_col_start = m_col;
+
+        if constexpr(TrackLines) {
+            m_line_start = m_line;
+            m_col_start = m_col;
+        }
+    }
+
+    // moves back to offset, which must lie inside the current token
+    void rewind(std::size_t offset) {
+        m_current = m_start;
+
+        if constexpr(TrackLines) {
+            m_line = m_line_start;
+            m_col = m_col_start;
+        }
+
+        while(m_current < m_str.data() + offset) {
+            advance();
+        }
     }
 
     void advance() {
-        if(*m_current == '\n') {
-            m_line++;
-            m_col = 0;
+        if constexpr(TrackLines) {
+            if(*m_current == '\n') {
+                m_line++;
+                m_col = 0;
+            }
+
+            m_col++;
         }
 
         m_current++;
-        m_col++;
+    }
+
+    // advance n <= 64 bytes, newlines holds the newline bits of the block starting at m_current
+    void advance_block(std::size_t n, [[maybe_unused]] std::uint64_t newlines) {
+        if constexpr(TrackLines) {
+            if(n < block_classifier::block_size) {
+                newlines &= (std::uint64_t(1) << n) - 1;
+            }
+
+            if(newlines) {
+                m_line += std::popcount(newlines);
+                m_col = static_cast<int>(n) - (63 - std::countl_zero(newlines));
+            } else {
+                m_col += static_cast<int>(n);
+            }
+        }
+
+        m_current += n;
+    }
+
+    // advance until the first byte whose bit is set in stop(masks), or to the end
+    template<typename Stop_F>
+    void skip_until(Stop_F stop) {
+        while(!end()) {
+            const std::size_t remaining = m_end - m_current;
+            const bool partial = remaining < block_classifier::block_size;
+            const BlockMasks masks = partial ? block_classifier::classify_partial(m_current, remaining) : block_classifier::classify(m_current);
+            std::uint64_t bits = stop(masks);
+
+            if(partial) {
+                bits |= ~std::uint64_t(0) << remaining;
+            }
+
+            const std::size_t n = bits ? std::countr_zero(bits) : block_classifier::block_size;
+            advance_block(n, masks.newline);
+
+            if(n < block_classifier::block_size) {
+                return;
+            }
+        }
+    }
+
+    // most runs are a single byte long, so those are checked before classifying a whole block
+    void skip_whitespace() {
+        if(char_class::is(peek(), char_class::space)) {
+            skip_until([](const BlockMasks &m) { return ~m.whitespace; });
+        }
+    }
+
+    void skip_identifier() {
+        if(char_class::is(peek(), char_class::ident_continue | char_class::dollar)) {
+            skip_until([](const BlockMasks &m) { return ~m.identifier; });
+        }
     }
 
     [[nodiscard]] char peek() const {
         return end() ? '\0' : *m_current;
     }
 
+    [[nodiscard]] char peek(std::size_t ahead) const {
+        return static_cast<std::size_t>(m_end - m_current) > ahead ? m_current[ahead] : '\0';
+    }
+
     char consume() {
         char c = peek();
         advance();
@@ -69,6 +159,11 @@ protected:
         return m_current >= m_end;
     }
 
+    // no new token may start here, lookahead can still see up to end()
+    [[nodiscard]] bool done() const {
+        return m_current >= m_limit;
+    }
+
     template<typename ...Args> requires ((std::same_as<char, Args>) && ...)
     bool check(Args ...c) {
         return !end() && ((c == peek()) || ...);
@@ -84,14 +179,37 @@ protected:
         return false;
     }
 
+    // consumes the longest operator of an OperatorTable at the current position
+    template<typename Table_T, typename Kind_T>
+    bool match_operator(const Table_T &table, Kind_T &kind) {
+        const std::size_t length = table.match(m_current, m_end, kind);
+        m_current += length;
+
+        if constexpr(TrackLines) {
+            m_col += static_cast<int>(length);
+        }
+
+        return length != 0;
+    }
+
 public:
     void lex(const std::string_view str) {
+        lex(str, 0, str.size());
+    }
+
+    // lex only the tokens starting in [begin, limit), offsets stay relative to str
+    void lex(const std::string_view str, std::size_t begin, std::size_t limit) {
         m_str = str;
-        m_current = m_str.data();
-        m_end = m_current + m_str.size();
+        m_current = m_str.data() + begin;
+        m_end = m_str.data() + m_str.size();
+        m_limit = m_str.data() + limit;
         m_line = 1;
         m_col = 1;
     }
+
+    [[nodiscard]] std::size_t offset() const {
+        return m_current - m_str.data();
+    }
 };
 
 #endif
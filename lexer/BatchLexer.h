@@ -0,0 +1,167 @@
+#ifndef BATCH_LEXER_H
+#define BATCH_LEXER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "SourceBuffer.h"
+#include "TokenCache.h"
+
+// Lexes many files on a pool of threads. Every worker owns one Lexer_T, one
+// token vector and one error vector that are reused from file to file.
+//
+// Files are sorted by size and dealt out largest first to per-worker queues.
+// A worker takes from the front of its own queue and, once that is empty, from
+// the front of another worker's queue, so the big files are started early and
+// nobody is left lexing one at the end while the others sit idle.
+//
+// Results come back in the order of the paths passed in, whatever thread
+// lexed each file.
+template<typename Lexer_T, typename Token_T>
+class BatchLexer {
+public:
+    using Error = typename Lexer_T::Error;
+
+    struct Result {
+        std::size_t bytes = 0;
+        std::size_t tokens = 0;
+        std::vector<Error> errors;
+        bool read = false;
+        bool cached = false;
+    };
+
+private:
+    struct alignas(64) Queue {
+        std::mutex mutex;
+        std::deque<std::size_t> files;
+    };
+
+    std::size_t m_threads;
+    Lexer_T m_prototype;
+    const TokenCache<Lexer_T, Token_T> *m_cache = nullptr;
+
+    static bool take(Queue &queue, std::size_t &file) {
+        std::lock_guard lock(queue.mutex);
+
+        if(queue.files.empty()) {
+            return false;
+        }
+
+        file = queue.files.front();
+        queue.files.pop_front();
+        return true;
+    }
+
+public:
+    explicit BatchLexer(std::size_t threads = std::thread::hardware_concurrency()) : m_threads(std::max<std::size_t>(threads, 1)) {}
+
+    // every worker lexes with a copy of lexer. Side tables it fills would be shared
+    // by all workers, so it must not have any
+    void set_lexer(const Lexer_T &lexer) {
+        m_prototype = lexer;
+    }
+
+    void set_error_recovery(bool recover) {
+        m_prototype.set_error_recovery(recover);
+    }
+
+    // files found in cache are not lexed, the others are added to it. nullptr turns caching off
+    void set_cache(const TokenCache<Lexer_T, Token_T> *cache) {
+        m_cache = cache;
+    }
+
+    // visit(index, source, tokens, errors) is called on the worker thread for
+    // every file that could be read; calls for different files may overlap
+    template<typename Visit_T>
+    std::vector<Result> lex(const std::vector<std::string> &paths, Visit_T &&visit) {
+        std::vector<Result> results(paths.size());
+        std::vector<std::size_t> order(paths.size());
+        std::iota(order.begin(), order.end(), 0);
+
+        for(std::size_t i = 0; i < paths.size(); i++) {
+            std::error_code ec;
+            const auto size = std::filesystem::file_size(paths[i], ec);
+            results[i].bytes = ec ? 0 : static_cast<std::size_t>(size);
+        }
+
+        std::stable_sort(order.begin(), order.end(), [&results](std::size_t a, std::size_t b) { return results[a].bytes > results[b].bytes; });
+
+        const std::size_t count = std::min(m_threads, std::max<std::size_t>(paths.size(), 1));
+        std::vector<Queue> queues(count);
+
+        for(std::size_t i = 0; i < order.size(); i++) {
+            queues[i % count].files.push_back(order[i]);
+        }
+
+        auto work = [&](std::size_t self) {
+            Lexer_T lexer = m_prototype;
+            std::vector<Token_T> tokens;
+            std::vector<Error> errors;
+            SourceBuffer source;
+            std::size_t file = 0;
+
+            while(true) {
+                bool found = take(queues[self], file);
+
+                for(std::size_t i = 1; !found && i < count; i++) {
+                    found = take(queues[(self + i) % count], file);
+                }
+
+                if(!found) {
+                    break;
+                }
+
+                Result &result = results[file];
+
+                if(!source.open(paths[file].c_str())) {
+                    continue;
+                }
+
+                tokens.clear();
+                errors.clear();
+
+                if(m_cache) {
+                    result.cached = m_cache->lex(lexer, source.view(), tokens, errors);
+                } else {
+                    lexer.lex(source.view(), tokens, errors);
+                }
+
+                visit(file, source.view(), tokens, errors);
+
+                result.read = true;
+                result.bytes = source.size();
+                result.tokens = tokens.size();
+                result.errors = errors;
+            }
+        };
+
+        std::vector<std::thread> threads;
+
+        for(std::size_t i = 1; i < count; i++) {
+            threads.emplace_back(work, i);
+        }
+
+        work(0);
+
+        for(auto &thread : threads) {
+            thread.join();
+        }
+
+        return results;
+    }
+
+    std::vector<Result> lex(const std::vector<std::string> &paths) {
+        return lex(paths, [](std::size_t, std::string_view, const std::vector<Token_T> &, const std::vector<Error> &) {});
+    }
+};
+
+#endif
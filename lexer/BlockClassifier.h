@@ -0,0 +1,167 @@
+#ifndef BLOCK_CLASSIFIER_H
+#define BLOCK_CLASSIFIER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BLOCK_CLASSIFIER_X86 1
+#endif
+
+#include "CharClass.h"
+
+// One bit per byte of a 64 byte block, bit i set if byte i is in the class.
+struct BlockMasks {
+    std::uint64_t whitespace;
+    std::uint64_t identifier;
+    std::uint64_t quote;
+    std::uint64_t backslash;
+    std::uint64_t newline;
+    std::uint64_t slash;
+    std::uint64_t star;
+};
+
+namespace block_classifier {
+
+constexpr std::size_t block_size = 64;
+
+inline BlockMasks classify_scalar(const char *p) {
+    BlockMasks m{};
+
+    for(std::size_t i = 0; i < block_size; i++) {
+        const char c = p[i];
+        const std::uint64_t bit = std::uint64_t(1) << i;
+
+        if(char_class::is(c, char_class::space)) {
+            m.whitespace |= bit;
+        }
+
+        if(char_class::is(c, char_class::ident_continue | char_class::dollar)) {
+            m.identifier |= bit;
+        }
+
+        if(c == '"' || c == '\'') {
+            m.quote |= bit;
+        }
+
+        if(c == '\\') {
+            m.backslash |= bit;
+        }
+
+        if(c == '\n') {
+            m.newline |= bit;
+        }
+
+        if(c == '/') {
+            m.slash |= bit;
+        }
+
+        if(c == '*') {
+            m.star |= bit;
+        }
+    }
+
+    return m;
+}
+
+#ifdef BLOCK_CLASSIFIER_X86
+
+inline __m128i in_range_sse2(__m128i v, char lo, char hi) {
+    return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(static_cast<char>(lo - 1))), _mm_cmplt_epi8(v, _mm_set1_epi8(static_cast<char>(hi + 1))));
+}
+
+inline std::uint64_t bits_sse2(__m128i v, std::size_t shift) {
+    return static_cast<std::uint64_t>(static_cast<std::uint16_t>(_mm_movemask_epi8(v))) << shift;
+}
+
+inline BlockMasks classify_sse2(const char *p) {
+    BlockMasks m{};
+
+    for(std::size_t i = 0; i < block_size; i += 16) {
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+        const __m128i lower = _mm_or_si128(c, _mm_set1_epi8(0x20));
+        const __m128i space = _mm_or_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8(' ')), in_range_sse2(c, '\t', '\r'));
+        const __m128i alnum = _mm_or_si128(in_range_sse2(lower, 'a', 'z'), in_range_sse2(c, '0', '9'));
+        const __m128i extra = _mm_or_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8('_')), _mm_cmpeq_epi8(c, _mm_set1_epi8('$')));
+        const __m128i quote = _mm_or_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8('"')), _mm_cmpeq_epi8(c, _mm_set1_epi8('\'')));
+
+        m.whitespace |= bits_sse2(space, i);
+        m.identifier |= bits_sse2(_mm_or_si128(alnum, extra), i);
+        m.quote |= bits_sse2(quote, i);
+        m.backslash |= bits_sse2(_mm_cmpeq_epi8(c, _mm_set1_epi8('\\')), i);
+        m.newline |= bits_sse2(_mm_cmpeq_epi8(c, _mm_set1_epi8('\n')), i);
+        m.slash |= bits_sse2(_mm_cmpeq_epi8(c, _mm_set1_epi8('/')), i);
+        m.star |= bits_sse2(_mm_cmpeq_epi8(c, _mm_set1_epi8('*')), i);
+    }
+
+    return m;
+}
+
+__attribute__((target("avx2"))) inline __m256i in_range_avx2(__m256i v, char lo, char hi) {
+    return _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(static_cast<char>(lo - 1))), _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(hi + 1)), v));
+}
+
+__attribute__((target("avx2"))) inline std::uint64_t bits_avx2(__m256i v, std::size_t shift) {
+    return static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(v))) << shift;
+}
+
+__attribute__((target("avx2"))) inline BlockMasks classify_avx2(const char *p) {
+    BlockMasks m{};
+
+    for(std::size_t i = 0; i < block_size; i += 32) {
+        const __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i));
+        const __m256i lower = _mm256_or_si256(c, _mm256_set1_epi8(0x20));
+        const __m256i space = _mm256_or_si256(_mm256_cmpeq_epi8(c, _mm256_set1_epi8(' ')), in_range_avx2(c, '\t', '\r'));
+        const __m256i alnum = _mm256_or_si256(in_range_avx2(lower, 'a', 'z'), in_range_avx2(c, '0', '9'));
+        const __m256i extra = _mm256_or_si256(_mm256_cmpeq_epi8(c, _mm256_set1_epi8('_')), _mm256_cmpeq_epi8(c, _mm256_set1_epi8('$')));
+        const __m256i quote = _mm256_or_si256(_mm256_cmpeq_epi8(c, _mm256_set1_epi8('"')), _mm256_cmpeq_epi8(c, _mm256_set1_epi8('\'')));
+
+        m.whitespace |= bits_avx2(space, i);
+        m.identifier |= bits_avx2(_mm256_or_si256(alnum, extra), i);
+        m.quote |= bits_avx2(quote, i);
+        m.backslash |= bits_avx2(_mm256_cmpeq_epi8(c, _mm256_set1_epi8('\\')), i);
+        m.newline |= bits_avx2(_mm256_cmpeq_epi8(c, _mm256_set1_epi8('\n')), i);
+        m.slash |= bits_avx2(_mm256_cmpeq_epi8(c, _mm256_set1_epi8('/')), i);
+        m.star |= bits_avx2(_mm256_cmpeq_epi8(c, _mm256_set1_epi8('*')), i);
+    }
+
+    return m;
+}
+
+#endif
+
+using classify_fn = BlockMasks (*)(const char *);
+
+inline classify_fn select() {
+#ifdef BLOCK_CLASSIFIER_X86
+    __builtin_cpu_init();
+
+    if(__builtin_cpu_supports("avx2")) {
+        return classify_avx2;
+    }
+
+    return classify_sse2;
+#else
+    return classify_scalar;
+#endif
+}
+
+inline const classify_fn classify_impl = select();
+
+// classifies the 64 bytes starting at p, which must all be readable
+inline BlockMasks classify(const char *p) {
+    return classify_impl(p);
+}
+
+// classifies the first n < 64 bytes starting at p, the remaining bits are clear
+inline BlockMasks classify_partial(const char *p, std::size_t n) {
+    char block[block_size] = {};
+    std::memcpy(block, p, n);
+    return classify_impl(block);
+}
+
+}
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef BRACKET_INDEX_H
+#define BRACKET_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Matching brackets of a token stream, filled in by a lexer while it lexes.
+// match() maps an opening bracket's token index to the index of its closing
+// bracket and the other way round, so skipping a body is one lookup.
+//
+// A closing bracket that does not fit the innermost open one closes the
+// nearest open bracket of its kind, leaving the ones in between unmatched. If
+// there is none it is unmatched itself.
+class BracketIndex {
+public:
+    static constexpr std::uint32_t no_match = ~std::uint32_t(0);
+
+private:
+    struct Open {
+        std::uint32_t token;
+        std::uint8_t kind;
+    };
+
+    std::vector<std::uint32_t> m_matches;
+    std::vector<std::uint32_t> m_unmatched;
+    std::vector<Open> m_open;
+
+    void link(std::size_t a, std::size_t b) {
+        if(m_matches.size() <= b) {
+            m_matches.resize(b + 1, no_match);
+        }
+
+        m_matches[a] = static_cast<std::uint32_t>(b);
+        m_matches[b] = static_cast<std::uint32_t>(a);
+    }
+
+public:
+    void clear() {
+        m_matches.clear();
+        m_unmatched.clear();
+        m_open.clear();
+    }
+
+    // kind tells (, [ and { apart, any small number as long as open and close agree
+    void open(std::size_t token, std::uint8_t kind) {
+        m_open.push_back({static_cast<std::uint32_t>(token), kind});
+    }
+
+    void close(std::size_t token, std::uint8_t kind) {
+        std::size_t i = m_open.size();
+
+        while(i > 0 && m_open[i - 1].kind != kind) {
+            i--;
+        }
+
+        if(i == 0) {
+            m_unmatched.push_back(static_cast<std::uint32_t>(token));
+            return;
+        }
+
+        for(std::size_t j = i; j < m_open.size(); j++) {
+            m_unmatched.push_back(m_open[j].token);
+        }
+
+        link(m_open[i - 1].token, token);
+        m_open.resize(i - 1);
+    }
+
+    // call once the stream is complete, tokens is its length
+    void finish(std::size_t tokens) {
+        for(const Open &open : m_open) {
+            m_unmatched.push_back(open.token);
+        }
+
+        m_open.clear();
+        m_matches.resize(tokens, no_match);
+    }
+
+    // index of the bracket matching token, or no_match
+    [[nodiscard]] std::uint32_t match(std::size_t token) const {
+        return token < m_matches.size() ? m_matches[token] : no_match;
+    }
+
+    // token indices of unbalanced brackets, not sorted
+    [[nodiscard]] const std::vector<std::uint32_t> &unmatched() const {
+        return m_unmatched;
+    }
+
+    [[nodiscard]] bool balanced() const {
+        return m_unmatched.empty() && m_open.empty();
+    }
+};
+
+#endif
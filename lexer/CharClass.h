@@ -0,0 +1,64 @@
+#ifndef CHAR_CLASS_H
+#define CHAR_CLASS_H
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+// Locale independent replacement for <cctype>, safe to call with negative chars.
+namespace char_class {
+
+enum : std::uint8_t {
+    space = 1 << 0,
+    digit = 1 << 1,
+    hex_digit = 1 << 2,
+    ident_start = 1 << 3,
+    ident_continue = 1 << 4,
+    operator_start = 1 << 5,
+    dollar = 1 << 6,
+};
+
+constexpr std::array<std::uint8_t, 256> make_table() {
+    std::array<std::uint8_t, 256> table{};
+
+    for(std::size_t c = 0; c < table.size(); c++) {
+        const bool is_digit = c >= '0' && c <= '9';
+        const bool is_alpha = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+
+        if(c == ' ' || (c >= '\t' && c <= '\r')) {
+            table[c] |= space;
+        }
+
+        if(is_digit) {
+            table[c] |= digit | hex_digit | ident_continue;
+        }
+
+        if((c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F')) {
+            table[c] |= hex_digit;
+        }
+
+        if(is_alpha || c == '_') {
+            table[c] |= ident_start | ident_continue;
+        }
+
+        if(std::string_view("=+-*/%^&|~!<>?:;,.()[]{}#").find(static_cast<char>(c)) != std::string_view::npos) {
+            table[c] |= operator_start;
+        }
+
+        if(c == '$') {
+            table[c] |= dollar;
+        }
+    }
+
+    return table;
+}
+
+inline constexpr std::array<std::uint8_t, 256> table = make_table();
+
+constexpr bool is(char c, std::uint8_t mask) {
+    return (table[static_cast<unsigned char>(c)] & mask) != 0;
+}
+
+}
+
+#endif
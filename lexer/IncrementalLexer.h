@@ -0,0 +1,163 @@
+#ifndef INCREMENTAL_LEXER_H
+#define INCREMENTAL_LEXER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "BaseLexer.h"
+
+// Replace `removed` bytes at `offset` with `inserted`.
+struct Edit {
+    std::size_t offset;
+    std::size_t removed;
+    std::string_view inserted;
+};
+
+// Keeps a token vector up to date while its source is edited. Only the tokens
+// around the edit are lexed again: lexing restarts at the last token that ends
+// clear of the edit and stops as soon as a new token begins where a token after
+// the edit used to begin, since from there on the old tokens are still valid.
+// They are only shifted by the change in length.
+template<typename Lexer_T, typename Token_T>
+class IncrementalLexer {
+public:
+    using Error = typename Lexer_T::Error;
+
+    // the furthest any token decision looks past the end of the token
+    static constexpr std::size_t lookahead = 4;
+
+private:
+    using text_type = decltype(Token_T::text);
+
+    Lexer_T m_lexer;
+    std::vector<Token_T> m_tokens;
+    std::vector<Error> m_errors;
+
+    static void rebase(std::string_view source, Token_T &token) {
+        token.text = text_type(source.substr(token.begin, token.end - token.begin));
+    }
+
+public:
+    // tokens and errors passed to apply() must have been lexed with the same setting
+    void set_error_recovery(bool recover) {
+        m_lexer.set_error_recovery(recover);
+    }
+
+    // applies edit to source, tokens and errors must hold the result of lexing source before the edit.
+    // returns the number of tokens that were lexed again
+    std::size_t apply(std::string &source, const Edit &edit, std::vector<Token_T> &tokens, std::vector<Error> &errors) {
+        const char *old_data = source.data();
+        source.replace(edit.offset, edit.removed, edit.inserted);
+
+        const std::string_view str = source;
+        const std::size_t old_edit_end = edit.offset + edit.removed;
+        const std::size_t new_edit_end = edit.offset + edit.inserted.size();
+
+        // restart at the last token whose end, plus lookahead, is clear of the edit
+        auto affected = std::partition_point(tokens.begin(), tokens.end(), [&](const Token_T &t) { return t.end + lookahead <= edit.offset; });
+        const bool has_base = affected != tokens.begin();
+        std::size_t first = has_base ? affected - tokens.begin() - 1 : 0;
+
+        // with recovery an unterminated literal is cut at its line end, a quote added
+        // anywhere after it can close it, so restart at the first one
+        auto open = std::find_if(errors.begin(), errors.end(), [&](const Error &e) { return e.code == ErrorCode::unterminated_string || e.code == ErrorCode::unterminated_comment; });
+
+        if(has_base && open != errors.end() && open->begin < tokens[first].begin) {
+            first = std::lower_bound(tokens.begin(), tokens.begin() + first, open->begin, [](const Token_T &t, std::size_t begin) { return t.begin < begin; }) - tokens.begin();
+        }
+
+        const std::size_t restart = has_base ? tokens[first].begin : 0;
+
+        auto tail = std::lower_bound(tokens.begin() + first, tokens.end(), old_edit_end, [](const Token_T &t, std::size_t begin) { return t.begin < begin; });
+        auto resync = tokens.end();
+        Token_T token;
+
+        m_tokens.clear();
+        m_errors.clear();
+        m_lexer.start(str, restart, str.size(), m_errors);
+
+        while(m_lexer.next_token(token)) {
+            if constexpr(LocatedToken<Token_T>) {
+                if(has_base) {
+                    token.col = token.line == 1 ? token.col + tokens[first].col - 1 : token.col;
+                    token.line += tokens[first].line - 1;
+                }
+            }
+
+            if(token.begin >= new_edit_end) {
+                const std::size_t old_begin = token.begin - new_edit_end + old_edit_end;
+                tail = std::lower_bound(tail, tokens.end(), old_begin, [](const Token_T &t, std::size_t begin) { return t.begin < begin; });
+
+                if(tail != tokens.end() && tail->begin == old_begin) {
+                    resync = tail;
+                    break;
+                }
+            }
+
+            m_tokens.push_back(token);
+        }
+
+        // errors before the restart stay, the ones of the lexed window are replaced
+        // and the ones from the resync token on are shifted like the tokens
+        auto window = std::partition_point(errors.begin(), errors.end(), [restart](const Error &e) { return e.begin < restart; });
+        auto shifted = errors.end();
+
+        if(resync != tokens.end()) {
+            // the resync token was lexed before it matched, its errors are among the shifted
+            m_errors.erase(std::partition_point(m_errors.begin(), m_errors.end(), [&](const Error &e) { return e.begin < token.begin; }), m_errors.end());
+            shifted = std::partition_point(window, errors.end(), [&](const Error &e) { return e.begin < resync->begin; });
+
+            for(auto it = shifted; it != errors.end(); ++it) {
+                it->begin = it->begin - old_edit_end + new_edit_end;
+                it->end = it->end - old_edit_end + new_edit_end;
+            }
+        }
+
+        window = errors.erase(window, shifted);
+        errors.insert(window, std::make_move_iterator(m_errors.begin()), std::make_move_iterator(m_errors.end()));
+
+        if(resync != tokens.end()) {
+            [[maybe_unused]] const Token_T old = *resync;
+
+            for(auto it = resync; it != tokens.end(); ++it) {
+                if constexpr(LocatedToken<Token_T>) {
+                    if(it->line == old.line) {
+                        it->col += token.col - old.col;
+                    }
+
+                    it->line += token.line - old.line;
+                }
+
+                it->begin = it->begin - old_edit_end + new_edit_end;
+                it->end = it->end - old_edit_end + new_edit_end;
+                rebase(str, *it);
+            }
+        }
+
+        // splice with at most one move of the tail
+        const std::size_t relexed = m_tokens.size();
+        const std::size_t replaced = resync - tokens.begin() - first;
+
+        if(relexed > replaced) {
+            tokens.insert(tokens.begin() + first + replaced, relexed - replaced, Token_T{});
+        } else {
+            tokens.erase(tokens.begin() + first + relexed, tokens.begin() + first + replaced);
+        }
+
+        std::copy(m_tokens.begin(), m_tokens.end(), tokens.begin() + first);
+
+        if(source.data() != old_data) {
+            for(std::size_t i = 0; i < first; i++) {
+                rebase(str, tokens[i]);
+            }
+        }
+
+        return relexed;
+    }
+};
+
+#endif
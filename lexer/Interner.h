@@ -0,0 +1,202 @@
+#ifndef INTERNER_H
+#define INTERNER_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+// Thread-safe string interner handing out dense 32-bit symbols. Strings are
+// copied once into per-shard arenas and never move, so name() stays valid for
+// the lifetime of the interner. The table is split into shards by hash, each
+// an open addressing table behind its own mutex. Symbol to name lookups go
+// through an array of chunks that double in size and is read without locking.
+class Interner {
+public:
+    static constexpr std::uint32_t no_symbol = ~std::uint32_t(0);
+
+    // a small per-thread, direct mapped front cache: repeated names are resolved
+    // without touching the shared table
+    class Cache {
+        struct Entry {
+            std::uint64_t hash = 0;
+            std::string_view name;
+            std::uint32_t symbol = no_symbol;
+        };
+
+        Interner *m_interner = nullptr;
+        std::array<Entry, 256> m_entries{};
+
+    public:
+        Cache() = default;
+
+        explicit Cache(Interner &interner) : m_interner(&interner) {}
+
+        [[nodiscard]] Interner *interner() const {
+            return m_interner;
+        }
+
+        std::uint32_t intern(std::string_view str) {
+            const std::uint64_t hash = Interner::hash(str);
+            Entry &entry = m_entries[hash & (m_entries.size() - 1)];
+
+            if(entry.hash == hash && entry.name == str) {
+                return entry.symbol;
+            }
+
+            const std::uint32_t symbol = m_interner->intern(str, hash);
+            entry = {hash, m_interner->name(symbol), symbol};
+            return symbol;
+        }
+    };
+
+private:
+    static constexpr std::size_t shard_bits = 6;
+    static constexpr std::size_t first_chunk_size = 1024;
+    static constexpr std::size_t arena_block_size = 64 * 1024;
+
+    struct Slot {
+        std::uint64_t hash = 0;
+        std::uint32_t symbol = no_symbol;
+    };
+
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        std::vector<Slot> slots = std::vector<Slot>(64);
+        std::size_t count = 0;
+        std::vector<std::unique_ptr<char[]>> blocks;
+        char *arena = nullptr;
+        std::size_t arena_left = 0;
+
+        std::string_view store(std::string_view str) {
+            if(str.size() > arena_left) {
+                const std::size_t size = std::max(arena_block_size, str.size());
+                blocks.push_back(std::make_unique<char[]>(size));
+                arena = blocks.back().get();
+                arena_left = size;
+            }
+
+            std::memcpy(arena, str.data(), str.size());
+            std::string_view stored(arena, str.size());
+            arena += str.size();
+            arena_left -= str.size();
+            return stored;
+        }
+    };
+
+    std::array<Shard, std::size_t(1) << shard_bits> m_shards;
+    std::array<std::atomic<std::string_view *>, 32> m_chunks{};
+    std::atomic<std::uint32_t> m_next{0};
+
+    // chunk k holds first_chunk_size << k names
+    static std::size_t chunk_index(std::uint32_t symbol) {
+        return std::bit_width(symbol / first_chunk_size + 1) - 1;
+    }
+
+    static std::size_t chunk_offset(std::uint32_t symbol, std::size_t chunk) {
+        return symbol - first_chunk_size * ((std::size_t(1) << chunk) - 1);
+    }
+
+    std::string_view &name_slot(std::uint32_t symbol) {
+        const std::size_t index = chunk_index(symbol);
+        auto &slot = m_chunks[index];
+        std::string_view *chunk = slot.load(std::memory_order_acquire);
+
+        if(!chunk) {
+            auto fresh = std::make_unique<std::string_view[]>(first_chunk_size << index);
+
+            if(slot.compare_exchange_strong(chunk, fresh.get(), std::memory_order_acq_rel)) {
+                chunk = fresh.release();
+            }
+        }
+
+        return chunk[chunk_offset(symbol, index)];
+    }
+
+    static void insert(std::vector<Slot> &slots, Slot slot) {
+        const std::size_t mask = slots.size() - 1;
+        std::size_t i = (slot.hash >> shard_bits) & mask;
+
+        while(slots[i].symbol != no_symbol) {
+            i = (i + 1) & mask;
+        }
+
+        slots[i] = slot;
+    }
+
+public:
+    Interner() = default;
+    Interner(const Interner &) = delete;
+    Interner &operator=(const Interner &) = delete;
+
+    ~Interner() {
+        for(auto &chunk : m_chunks) {
+            delete[] chunk.load(std::memory_order_relaxed);
+        }
+    }
+
+    // FNV-1a, identifiers are short enough that anything fancier does not pay off
+    static std::uint64_t hash(std::string_view str) {
+        std::uint64_t hash = 0xcbf29ce484222325;
+
+        for(char c : str) {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3;
+        }
+
+        return hash;
+    }
+
+    std::uint32_t intern(std::string_view str) {
+        return intern(str, hash(str));
+    }
+
+    std::uint32_t intern(std::string_view str, std::uint64_t hash) {
+        Shard &shard = m_shards[hash & (m_shards.size() - 1)];
+        std::lock_guard lock(shard.mutex);
+
+        const std::size_t mask = shard.slots.size() - 1;
+
+        for(std::size_t i = (hash >> shard_bits) & mask; shard.slots[i].symbol != no_symbol; i = (i + 1) & mask) {
+            if(shard.slots[i].hash == hash && name(shard.slots[i].symbol) == str) {
+                return shard.slots[i].symbol;
+            }
+        }
+
+        const std::uint32_t symbol = m_next.fetch_add(1, std::memory_order_relaxed);
+        name_slot(symbol) = shard.store(str);
+
+        if(++shard.count * 2 > shard.slots.size()) {
+            std::vector<Slot> slots(shard.slots.size() * 2);
+
+            for(const Slot &slot : shard.slots) {
+                if(slot.symbol != no_symbol) {
+                    insert(slots, slot);
+                }
+            }
+
+            shard.slots = std::move(slots);
+        }
+
+        insert(shard.slots, {hash, symbol});
+        return symbol;
+    }
+
+    // symbol must have been returned by intern(), on this or a synchronized thread
+    [[nodiscard]] std::string_view name(std::uint32_t symbol) const {
+        const std::size_t index = chunk_index(symbol);
+        return m_chunks[index].load(std::memory_order_acquire)[chunk_offset(symbol, index)];
+    }
+
+    [[nodiscard]] std::size_t size() const {
+        return m_next.load(std::memory_order_relaxed);
+    }
+};
+
+#endif
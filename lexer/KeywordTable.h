@@ -0,0 +1,96 @@
+#ifndef KEYWORD_TABLE_H
+#define KEYWORD_TABLE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Perfect hash over a fixed set of keywords, found at compile time. The length
+// and the first, middle and last character are packed into 32 bits and hashed
+// by multiply-shift, so a lookup is a few instructions, one table load and one
+// compare against the only keyword that can match.
+template<std::size_t N, unsigned Bits = 10>
+class KeywordTable {
+    static constexpr std::size_t table_size = std::size_t(1) << Bits;
+
+    static_assert(N < 255 && N <= table_size);
+
+    std::array<std::string_view, N> m_words;
+    std::array<std::uint8_t, table_size> m_slots{};
+    std::uint32_t m_multiplier = 0;
+    std::size_t m_min_length = ~std::size_t(0);
+    std::size_t m_max_length = 0;
+
+    static constexpr std::size_t hash(std::uint32_t multiplier, std::string_view s) {
+        const std::uint32_t key = static_cast<unsigned char>(s[0])
+            | static_cast<std::uint32_t>(static_cast<unsigned char>(s[s.size() / 2])) << 8
+            | static_cast<std::uint32_t>(static_cast<unsigned char>(s[s.size() - 1])) << 16
+            | static_cast<std::uint32_t>(s.size()) << 24;
+
+        return (key * multiplier) >> (32 - Bits);
+    }
+
+    constexpr bool try_multiplier(std::uint32_t multiplier) {
+        for(std::size_t i = 0; i < N; i++) {
+            auto &slot = m_slots[hash(multiplier, m_words[i])];
+
+            if(slot) {
+                for(std::size_t j = 0; j < i; j++) {
+                    m_slots[hash(multiplier, m_words[j])] = 0;
+                }
+
+                return false;
+            }
+
+            slot = static_cast<std::uint8_t>(i + 1);
+        }
+
+        m_multiplier = multiplier;
+        return true;
+    }
+
+public:
+    constexpr explicit KeywordTable(const std::array<std::string_view, N> &words) : m_words(words) {
+        for(auto word : m_words) {
+            m_min_length = word.size() < m_min_length ? word.size() : m_min_length;
+            m_max_length = word.size() > m_max_length ? word.size() : m_max_length;
+        }
+
+        if(m_min_length == 0) {
+            return;
+        }
+
+        std::uint32_t multiplier = 0x9e3779b1;
+
+        for(int attempt = 0; attempt < 4096; attempt++) {
+            if(try_multiplier(multiplier)) {
+                return;
+            }
+
+            multiplier = (multiplier * 0x2545f491 + 0x6b43a9b5) | 1;
+        }
+    }
+
+    // false if no multiplier was found, check with a static_assert
+    [[nodiscard]] constexpr bool ok() const {
+        return m_multiplier != 0;
+    }
+
+    // index of s in the keyword list, or -1
+    [[nodiscard]] constexpr int find(std::string_view s) const {
+        if(s.size() < m_min_length || s.size() > m_max_length) {
+            return -1;
+        }
+
+        const std::uint8_t slot = m_slots[hash(m_multiplier, s)];
+
+        if(!slot || m_words[slot - 1] != s) {
+            return -1;
+        }
+
+        return slot - 1;
+    }
+};
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef LINE_INDEX_H
+#define LINE_INDEX_H
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "BlockClassifier.h"
+
+// Maps byte offsets to 1-based line and column numbers, counted the same way
+// BaseLexerCore<true> counts them.
+class LineIndex {
+    std::vector<std::size_t> m_line_starts;
+
+public:
+    struct Location {
+        int line;
+        int col;
+    };
+
+    LineIndex() = default;
+
+    explicit LineIndex(std::string_view str) {
+        build(str);
+    }
+
+    void build(std::string_view str) {
+        m_line_starts.clear();
+        m_line_starts.push_back(0);
+
+        for(std::size_t offset = 0; offset < str.size(); offset += block_classifier::block_size) {
+            const std::size_t remaining = str.size() - offset;
+            std::uint64_t newlines = remaining < block_classifier::block_size
+                ? block_classifier::classify_partial(str.data() + offset, remaining).newline
+                : block_classifier::classify(str.data() + offset).newline;
+
+            while(newlines) {
+                m_line_starts.push_back(offset + std::countr_zero(newlines) + 1);
+                newlines &= newlines - 1;
+            }
+        }
+    }
+
+    [[nodiscard]] Location location(std::size_t offset) const {
+        auto it = std::upper_bound(m_line_starts.begin(), m_line_starts.end(), offset) - 1;
+        return {static_cast<int>(it - m_line_starts.begin()) + 1, static_cast<int>(offset - *it) + 1};
+    }
+
+    // walks forward from the previous lookup, cheaper than location() when
+    // offsets come in increasing order as they do from a token stream
+    class Cursor {
+        const LineIndex *m_index;
+        std::size_t m_line = 0;
+
+    public:
+        explicit Cursor(const LineIndex &index) : m_index(&index) {}
+
+        [[nodiscard]] Location location(std::size_t offset) {
+            const auto &starts = m_index->m_line_starts;
+
+            if(offset < starts[m_line]) {
+                m_line = 0;
+            }
+
+            while(m_line + 1 < starts.size() && starts[m_line + 1] <= offset) {
+                m_line++;
+            }
+
+            return {static_cast<int>(m_line) + 1, static_cast<int>(offset - starts[m_line]) + 1};
+        }
+    };
+
+    [[nodiscard]] std::size_t lines() const {
+        return m_line_starts.size();
+    }
+};
+
+#endif
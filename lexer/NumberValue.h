@@ -0,0 +1,181 @@
+#ifndef NUMBER_VALUE_H
+#define NUMBER_VALUE_H
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+// Value of a numeric literal, decoded by a lexer while it lexes the literal
+struct NumberValue {
+    enum class Type : std::uint8_t {
+        integer,
+        floating,
+        // too large for std::uint64_t or double
+        out_of_range,
+    };
+
+    static constexpr std::uint8_t suffix_unsigned = 1 << 0;
+    // l or L, on a floating literal long double
+    static constexpr std::uint8_t suffix_long = 1 << 1;
+    static constexpr std::uint8_t suffix_long_long = 1 << 2;
+    static constexpr std::uint8_t suffix_size = 1 << 3;
+    static constexpr std::uint8_t suffix_float = 1 << 4;
+    // f16, f32, f64, f128 and bf16
+    static constexpr std::uint8_t suffix_extended = 1 << 5;
+    // a user-defined literal like 10ms or 1.5_km
+    static constexpr std::uint8_t suffix_user = 1 << 6;
+
+    Type type = Type::integer;
+    std::uint8_t suffix = 0;
+    std::uint64_t integer = 0;
+    double floating = 0;
+
+    [[nodiscard]] bool fits_int64() const {
+        return type == Type::integer && integer <= static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max());
+    }
+
+    [[nodiscard]] std::int64_t as_int64() const {
+        return static_cast<std::int64_t>(integer);
+    }
+};
+
+// digits is the literal without its base prefix and suffix, with any ' separators.
+// Floating literals in base 16 are expected to have a p exponent
+inline NumberValue decode_number(std::string_view digits, int base, bool floating) {
+    char buffer[64];
+    std::string long_buffer;
+
+    if(digits.find('\'') != std::string_view::npos) {
+        char *out = buffer;
+
+        if(digits.size() > sizeof(buffer)) {
+            long_buffer.resize(digits.size());
+            out = long_buffer.data();
+        }
+
+        const char *const first = out;
+
+        for(char c : digits) {
+            if(c != '\'') {
+                *out++ = c;
+            }
+        }
+
+        digits = std::string_view(first, out - first);
+    }
+
+    NumberValue value;
+    std::from_chars_result result;
+    const char *const end = digits.data() + digits.size();
+
+    if(floating) {
+        value.type = NumberValue::Type::floating;
+        result = std::from_chars(digits.data(), end, value.floating, base == 16 ? std::chars_format::hex : std::chars_format::general);
+    } else {
+        result = std::from_chars(digits.data(), end, value.integer, base);
+    }
+
+    if(result.ec != std::errc() || result.ptr != end) {
+        value.type = NumberValue::Type::out_of_range;
+    }
+
+    return value;
+}
+
+// flags of a literal suffix, any suffix that is not built in is user-defined
+inline std::uint8_t number_suffix_flags(std::string_view suffix, bool floating) {
+    if(suffix.empty()) {
+        return 0;
+    }
+
+    if(floating) {
+        if(suffix == "f" || suffix == "F") {
+            return NumberValue::suffix_float;
+        } else if(suffix == "l" || suffix == "L") {
+            return NumberValue::suffix_long;
+        } else if(suffix == "f16" || suffix == "f32" || suffix == "f64" || suffix == "f128" || suffix == "bf16"
+            || suffix == "F16" || suffix == "F32" || suffix == "F64" || suffix == "F128" || suffix == "BF16") {
+            return NumberValue::suffix_extended;
+        }
+
+        return NumberValue::suffix_user;
+    }
+
+    // u, l, ll and z in any order, each at most once, and not l with z
+    constexpr std::uint8_t length_flags = NumberValue::suffix_long | NumberValue::suffix_long_long | NumberValue::suffix_size;
+    std::uint8_t flags = 0;
+
+    for(std::size_t i = 0; i < suffix.size(); i++) {
+        const char c = suffix[i];
+        std::uint8_t flag;
+
+        if(c == 'u' || c == 'U') {
+            flag = NumberValue::suffix_unsigned;
+        } else if(c == 'z' || c == 'Z') {
+            flag = NumberValue::suffix_size;
+        } else if(c == 'l' || c == 'L') {
+            flag = NumberValue::suffix_long;
+
+            if(i + 1 < suffix.size() && suffix[i + 1] == c) {
+                flag = NumberValue::suffix_long_long;
+                i++;
+            }
+        } else {
+            return NumberValue::suffix_user;
+        }
+
+        if((flags & flag) || ((flag & length_flags) && (flags & length_flags))) {
+            return NumberValue::suffix_user;
+        }
+
+        flags |= flag;
+    }
+
+    return flags;
+}
+
+// Decoded values of the number tokens of a stream, filled in by a lexer while it
+// lexes. Token indices count from the first token of the run, like BracketIndex.
+// A TokenCache hit does not run the lexer, so it leaves the values empty.
+class NumberValues {
+    std::vector<std::uint32_t> m_tokens;
+    std::vector<NumberValue> m_values;
+
+public:
+    void clear() {
+        m_tokens.clear();
+        m_values.clear();
+    }
+
+    // tokens must be added in increasing order
+    void add(std::size_t token, const NumberValue &value) {
+        m_tokens.push_back(static_cast<std::uint32_t>(token));
+        m_values.push_back(value);
+    }
+
+    // the value of the number token at index token, nullptr if it has none
+    [[nodiscard]] const NumberValue *find(std::size_t token) const {
+        auto it = std::lower_bound(m_tokens.begin(), m_tokens.end(), token);
+        return it != m_tokens.end() && *it == token ? &m_values[it - m_tokens.begin()] : nullptr;
+    }
+
+    [[nodiscard]] std::size_t size() const {
+        return m_values.size();
+    }
+
+    [[nodiscard]] std::size_t token(std::size_t i) const {
+        return m_tokens[i];
+    }
+
+    [[nodiscard]] const NumberValue &value(std::size_t i) const {
+        return m_values[i];
+    }
+};
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef OPERATOR_TABLE_H
+#define OPERATOR_TABLE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+template<typename Kind_T>
+struct Operator {
+    std::string_view text;
+    Kind_T kind;
+};
+
+// Longest match recognizer for a fixed set of operators, built at compile time.
+// Every character used by an operator gets a small class number and the
+// operators form a trie stored as a (state, class) transition table, so matching
+// is one table lookup per character instead of a branch per candidate.
+template<typename Kind_T, std::size_t N, std::size_t MaxLength = 3>
+class OperatorTable {
+    static constexpr std::size_t max_states = 2 + N * MaxLength;
+    static constexpr std::size_t max_classes = 32;
+
+    static_assert(max_states <= 256);
+
+    // state 0 is the dead state, 1 the start, class 0 every other character
+    std::array<std::uint8_t, 256> m_classes{};
+    std::array<std::array<std::uint8_t, max_classes>, max_states> m_next{};
+    std::array<Kind_T, max_states> m_kinds{};
+    std::array<bool, max_states> m_accepting{};
+    std::size_t m_class_count = 1;
+    std::size_t m_state_count = 2;
+    bool m_ok = true;
+
+    constexpr std::uint8_t char_class(char c) {
+        auto &cls = m_classes[static_cast<unsigned char>(c)];
+
+        if(!cls) {
+            if(m_class_count == max_classes) {
+                m_ok = false;
+                return 0;
+            }
+
+            cls = static_cast<std::uint8_t>(m_class_count++);
+        }
+
+        return cls;
+    }
+
+public:
+    // operators must be unique, non-empty, at most MaxLength long and not contain newlines
+    constexpr explicit OperatorTable(const std::array<Operator<Kind_T>, N> &operators) {
+        for(const auto &op : operators) {
+            if(op.text.empty() || op.text.size() > MaxLength || op.text.find('\n') != std::string_view::npos) {
+                m_ok = false;
+                return;
+            }
+
+            std::size_t state = 1;
+
+            for(char c : op.text) {
+                auto &next = m_next[state][char_class(c)];
+
+                if(!next) {
+                    next = static_cast<std::uint8_t>(m_state_count++);
+                }
+
+                state = next;
+            }
+
+            if(m_accepting[state]) {
+                m_ok = false;
+            }
+
+            m_accepting[state] = true;
+            m_kinds[state] = op.kind;
+        }
+    }
+
+    [[nodiscard]] constexpr bool ok() const {
+        return m_ok;
+    }
+
+    // length of the longest operator at the start of [p, end) with its kind, 0 if there is none
+    constexpr std::size_t match(const char *p, const char *end, Kind_T &kind) const {
+        std::size_t state = 1;
+        std::size_t length = 0;
+
+        for(std::size_t i = 0; i < MaxLength && p + i < end; i++) {
+            state = m_next[state][m_classes[static_cast<unsigned char>(p[i])]];
+
+            if(!state) {
+                break;
+            }
+
+            if(m_accepting[state]) {
+                kind = m_kinds[state];
+                length = i + 1;
+            }
+        }
+
+        return length;
+    }
+};
+
+#endif
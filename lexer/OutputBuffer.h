@@ -0,0 +1,160 @@
+#ifndef OUTPUT_BUFFER_H
+#define OUTPUT_BUFFER_H
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <type_traits>
+
+#include <unistd.h>
+
+// Large write buffer in front of a file descriptor. Formatting goes straight
+// into the buffer and it is handed to write(2) only when full, so printing a
+// token costs a few memcpys instead of a stdio call. Do not mix with stdio on
+// the same descriptor.
+class OutputBuffer {
+    int m_fd;
+    std::unique_ptr<char[]> m_data;
+    std::size_t m_capacity;
+    std::size_t m_size = 0;
+    bool m_ok = true;
+
+    void reserve(std::size_t size) {
+        if(m_capacity - m_size < size) {
+            flush();
+        }
+    }
+
+public:
+    // the largest single put, digits of a 64 bit number with sign
+    static constexpr std::size_t max_number_size = 24;
+
+    explicit OutputBuffer(int fd = STDOUT_FILENO, std::size_t capacity = 1 << 20) :
+        m_fd(fd), m_data(std::make_unique<char[]>(std::max(capacity, max_number_size))), m_capacity(std::max(capacity, max_number_size)) {}
+
+    OutputBuffer(const OutputBuffer &) = delete;
+    OutputBuffer &operator=(const OutputBuffer &) = delete;
+
+    ~OutputBuffer() {
+        flush();
+    }
+
+    // false once a write failed, everything after that is dropped
+    bool flush() {
+        for(std::size_t written = 0; m_ok && written < m_size;) {
+            ssize_t n = ::write(m_fd, m_data.get() + written, m_size - written);
+
+            if(n < 0 && errno == EINTR) {
+                continue;
+            }
+
+            if(n <= 0) {
+                m_ok = false;
+            } else {
+                written += static_cast<std::size_t>(n);
+            }
+        }
+
+        m_size = 0;
+        return m_ok;
+    }
+
+    [[nodiscard]] bool ok() const {
+        return m_ok;
+    }
+
+    void put(char c) {
+        reserve(1);
+        m_data[m_size++] = c;
+    }
+
+    void put(std::string_view str) {
+        if(str.size() > m_capacity - m_size) {
+            flush();
+
+            if(str.size() >= m_capacity) {
+                for(std::size_t written = 0; m_ok && written < str.size();) {
+                    ssize_t n = ::write(m_fd, str.data() + written, str.size() - written);
+
+                    if(n < 0 && errno == EINTR) {
+                        continue;
+                    }
+
+                    m_ok = n > 0;
+                    written += n > 0 ? static_cast<std::size_t>(n) : 0;
+                }
+
+                return;
+            }
+        }
+
+        std::memcpy(m_data.get() + m_size, str.data(), str.size());
+        m_size += str.size();
+    }
+
+    template<typename Int_T> requires std::is_integral_v<Int_T>
+    void put_number(Int_T value) {
+        reserve(max_number_size);
+        m_size = std::to_chars(m_data.get() + m_size, m_data.get() + m_capacity, value).ptr - m_data.get();
+    }
+
+    // host byte order
+    template<typename T> requires std::is_trivially_copyable_v<T>
+    void put_raw(const T &value) {
+        put(std::string_view(reinterpret_cast<const char *>(&value), sizeof(T)));
+    }
+};
+
+// a JSON string literal, control characters escaped
+inline void put_json_string(OutputBuffer &out, std::string_view str) {
+    static constexpr char hex[] = "0123456789abcdef";
+
+    out.put('"');
+
+    for(std::size_t i = 0; i < str.size();) {
+        std::size_t plain = i;
+
+        while(plain < str.size() && static_cast<unsigned char>(str[plain]) >= 0x20 && str[plain] != '"' && str[plain] != '\\') {
+            plain++;
+        }
+
+        out.put(str.substr(i, plain - i));
+        i = plain;
+
+        if(i == str.size()) {
+            break;
+        }
+
+        const char c = str[i++];
+
+        switch(c) {
+        case '"':
+            out.put("\\\"");
+            break;
+        case '\\':
+            out.put("\\\\");
+            break;
+        case '\n':
+            out.put("\\n");
+            break;
+        case '\r':
+            out.put("\\r");
+            break;
+        case '\t':
+            out.put("\\t");
+            break;
+        default:
+            out.put("\\u00");
+            out.put(hex[static_cast<unsigned char>(c) >> 4]);
+            out.put(hex[static_cast<unsigned char>(c) & 15]);
+        }
+    }
+
+    out.put('"');
+}
+
+#endif
@@ -0,0 +1,160 @@
+#ifndef PARALLEL_LEXER_H
+#define PARALLEL_LEXER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Lexes one input on several threads and produces exactly the tokens and errors
+// of a serial Lexer_T::lex().
+//
+// The input is cut into segments at line starts and every segment is lexed
+// speculatively, as if it began between two tokens. Lexing a segment stops at
+// the first token boundary at or past its end, which is where the next segment
+// really starts. When that differs from where the segment was cut (a comment or
+// string ran over the cut), the segment is lexed again from the real start until
+// a token begins at the same offset as a speculative one. From there on both
+// agree, since the lexer state between tokens is only the position.
+//
+// Segments are lexed by copies of a configured lexer, set_lexer() refuses one
+// whose state between tokens is more than the position.
+template<typename Lexer_T, typename Token_T>
+class ParallelLexer {
+public:
+    using Error = typename Lexer_T::Error;
+
+private:
+    struct Segment {
+        std::size_t begin;
+        std::size_t limit;
+        std::size_t stop;
+        std::vector<Token_T> tokens;
+        std::vector<Error> errors;
+    };
+
+    std::size_t m_threads;
+    std::size_t m_min_segment_size;
+    Lexer_T m_prototype;
+    std::vector<Segment> m_segments;
+
+    void split(std::string_view str, std::size_t count) {
+        m_segments.clear();
+        std::size_t begin = 0;
+
+        for(std::size_t i = 1; i <= count && begin < str.size(); i++) {
+            std::size_t limit = i == count ? str.size() : str.size() / count * i;
+
+            if(limit < str.size()) {
+                limit = std::min(str.find('\n', std::max(limit, begin)), str.size() - 1) + 1;
+            }
+
+            m_segments.push_back({begin, limit, 0, {}, {}});
+            begin = limit;
+        }
+    }
+
+    // relex segment from its true start `from`, until it agrees with the speculative tokens
+    void repair(std::string_view str, Segment &segment, std::size_t from) const {
+        Lexer_T lexer = m_prototype;
+        std::vector<Token_T> tokens;
+        std::vector<Error> errors;
+        Token_T token;
+
+        lexer.start(str, from, segment.limit, errors);
+
+        while(lexer.next_token(token)) {
+            auto it = std::lower_bound(segment.tokens.begin(), segment.tokens.end(), token.begin, [](const Token_T &t, std::size_t begin) { return t.begin < begin; });
+
+            if(it != segment.tokens.end() && it->begin == token.begin) {
+                auto from_token = [&token](const Error &e) { return e.begin >= token.begin; };
+                errors.erase(std::find_if(errors.begin(), errors.end(), from_token), errors.end());
+                errors.insert(errors.end(), std::find_if(segment.errors.begin(), segment.errors.end(), from_token), segment.errors.end());
+                tokens.insert(tokens.end(), it, segment.tokens.end());
+                segment.tokens = std::move(tokens);
+                segment.errors = std::move(errors);
+                segment.begin = from;
+                return;
+            }
+
+            tokens.push_back(token);
+        }
+
+        segment.tokens = std::move(tokens);
+        segment.errors = std::move(errors);
+        segment.begin = from;
+        segment.stop = lexer.offset();
+    }
+
+public:
+    explicit ParallelLexer(std::size_t threads = std::thread::hardware_concurrency(), std::size_t min_segment_size = 256 * 1024) :
+        m_threads(std::max<std::size_t>(threads, 1)), m_min_segment_size(std::max<std::size_t>(min_segment_size, 1)) {}
+
+    // segments are lexed with copies of lexer. false, and the lexer unchanged, if
+    // lexer cannot be split
+    bool set_lexer(const Lexer_T &lexer) {
+        if constexpr(requires { lexer.splittable(); }) {
+            if(!lexer.splittable()) {
+                return false;
+            }
+        }
+
+        m_prototype = lexer;
+        return true;
+    }
+
+    void set_error_recovery(bool recover) {
+        m_prototype.set_error_recovery(recover);
+    }
+
+    void lex(std::string_view str, std::vector<Token_T> &tokens, std::vector<Error> &errors) {
+        const std::size_t count = std::min(m_threads, std::max<std::size_t>(str.size() / m_min_segment_size, 1));
+
+        if(count == 1) {
+            Lexer_T lexer = m_prototype;
+            lexer.lex(str, tokens, errors);
+            return;
+        }
+
+        split(str, count);
+
+        std::vector<std::thread> threads;
+
+        for(auto &segment : m_segments) {
+            threads.emplace_back([this, &str, &segment]() {
+                Lexer_T lexer = m_prototype;
+                lexer.lex(str, segment.begin, segment.limit, segment.tokens, segment.errors);
+                segment.stop = lexer.offset();
+            });
+        }
+
+        for(auto &thread : threads) {
+            thread.join();
+        }
+
+        std::size_t position = 0;
+
+        for(auto &segment : m_segments) {
+            if(position >= segment.limit) {
+                continue;
+            }
+
+            if(position != segment.begin) {
+                repair(str, segment, position);
+            }
+
+            tokens.insert(tokens.end(), segment.tokens.begin(), segment.tokens.end());
+
+            errors.insert(errors.end(), segment.errors.begin(), segment.errors.end());
+
+            if(!segment.errors.empty() && !m_prototype.error_recovery()) {
+                break;
+            }
+
+            position = segment.stop;
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,137 @@
+#ifndef SOURCE_BUFFER_H
+#define SOURCE_BUFFER_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Read-only view of a whole input file. Regular files are mapped into memory,
+// anything else (pipes, ttys, procfs) is read into an owned buffer.
+class SourceBuffer {
+    const char *m_data = nullptr;
+    std::size_t m_size = 0;
+    bool m_mapped = false;
+    std::string m_storage;
+
+    bool read_all(int fd, std::size_t size_hint) {
+        m_storage.resize(size_hint > 0 ? size_hint : 64 * 1024);
+        std::size_t size = 0;
+
+        while(true) {
+            if(size == m_storage.size()) {
+                m_storage.resize(m_storage.size() * 2);
+            }
+
+            ssize_t n = ::read(fd, m_storage.data() + size, m_storage.size() - size);
+
+            if(n < 0) {
+                return false;
+            } else if(n == 0) {
+                break;
+            }
+
+            size += static_cast<std::size_t>(n);
+        }
+
+        m_storage.resize(size);
+        return true;
+    }
+
+public:
+    SourceBuffer() = default;
+
+    SourceBuffer(const SourceBuffer &) = delete;
+    SourceBuffer &operator=(const SourceBuffer &) = delete;
+
+    SourceBuffer(SourceBuffer &&other) noexcept {
+        *this = std::move(other);
+    }
+
+    SourceBuffer &operator=(SourceBuffer &&other) noexcept {
+        if(this != &other) {
+            close();
+            m_data = std::exchange(other.m_data, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+            m_mapped = std::exchange(other.m_mapped, false);
+            m_storage = std::move(other.m_storage);
+        }
+
+        return *this;
+    }
+
+    ~SourceBuffer() {
+        close();
+    }
+
+    // "-" reads from stdin
+    bool open(const char *filename) {
+        close();
+
+        bool is_stdin = std::string_view(filename) == "-";
+        int fd = is_stdin ? STDIN_FILENO : ::open(filename, O_RDONLY);
+
+        if(fd < 0) {
+            return false;
+        }
+
+        struct stat st{};
+        bool ok = ::fstat(fd, &st) == 0;
+
+        if(ok && S_ISREG(st.st_mode) && st.st_size > 0) {
+            std::size_t size = static_cast<std::size_t>(st.st_size);
+            void *data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+            if(data != MAP_FAILED) {
+                ::madvise(data, size, MADV_SEQUENTIAL);
+                m_data = static_cast<const char *>(data);
+                m_size = size;
+                m_mapped = true;
+            } else {
+                ok = read_all(fd, size);
+            }
+        } else if(ok) {
+            ok = read_all(fd, 0);
+        }
+
+        if(!is_stdin) {
+            ::close(fd);
+        }
+
+        if(!ok) {
+            close();
+        }
+
+        return ok;
+    }
+
+    void close() {
+        if(m_mapped) {
+            ::munmap(const_cast<char *>(m_data), m_size);
+        }
+
+        m_data = nullptr;
+        m_size = 0;
+        m_mapped = false;
+        m_storage.clear();
+    }
+
+    [[nodiscard]] std::string_view view() const {
+        return m_mapped ? std::string_view(m_data, m_size) : std::string_view(m_storage);
+    }
+
+    [[nodiscard]] std::size_t size() const {
+        return view().size();
+    }
+
+    [[nodiscard]] bool mapped() const {
+        return m_mapped;
+    }
+};
+
+#endif
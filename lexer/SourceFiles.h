@@ -0,0 +1,82 @@
+#ifndef SOURCE_FILES_H
+#define SOURCE_FILES_H
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include <glob.h>
+
+inline constexpr std::array<std::string_view, 10> source_extensions = {".h", ".hh", ".hpp", ".hxx", ".inl", ".ipp", ".c", ".cc", ".cpp", ".cxx"};
+
+inline bool is_source_file(const std::filesystem::path &path) {
+    const std::string extension = path.extension().string();
+    return std::find(source_extensions.begin(), source_extensions.end(), extension) != source_extensions.end();
+}
+
+// Expands one command line input into file paths: a directory is searched
+// recursively for source files, "@list" reads one input per line from list and
+// anything with a wildcard goes through glob(3). Plain paths are taken as they
+// are. Returns false if an input could not be read or matched nothing.
+inline bool collect_sources(std::string_view input, std::vector<std::string> &paths) {
+    namespace fs = std::filesystem;
+
+    if(input.starts_with('@')) {
+        std::ifstream list{std::string(input.substr(1))};
+
+        if(!list) {
+            return false;
+        }
+
+        bool ok = true;
+
+        for(std::string line; std::getline(list, line);) {
+            if(!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+
+            if(!line.empty() && !line.starts_with('#')) {
+                ok = collect_sources(line, paths) && ok;
+            }
+        }
+
+        return ok;
+    }
+
+    if(input.find_first_of("*?[") != std::string_view::npos) {
+        glob_t matches{};
+        const int result = ::glob(std::string(input).c_str(), 0, nullptr, &matches);
+        bool ok = result == 0;
+
+        for(std::size_t i = 0; ok && i < matches.gl_pathc; i++) {
+            ok = collect_sources(matches.gl_pathv[i], paths);
+        }
+
+        ::globfree(&matches);
+        return ok;
+    }
+
+    std::error_code ec;
+
+    if(fs::is_directory(input, ec)) {
+        const auto options = fs::directory_options::skip_permission_denied;
+
+        for(fs::recursive_directory_iterator it(input, options, ec), end; !ec && it != end; it.increment(ec)) {
+            if(it->is_regular_file(ec) && is_source_file(it->path())) {
+                paths.push_back(it->path().string());
+            }
+        }
+
+        return !ec;
+    }
+
+    paths.emplace_back(input);
+    return true;
+}
+
+#endif
@@ -0,0 +1,185 @@
+#ifndef STREAM_LEXER_H
+#define STREAM_LEXER_H
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "BaseLexer.h"
+
+// A lexer that can describe an unfinished tail, and scan on through new input
+// until the token it starts has ended, see cpp_lexer::Lexer::Continuation.
+template<typename Lexer_T>
+concept ContinuableLexer = requires(typename Lexer_T::Continuation c, std::string_view text, std::size_t from) {
+    { Lexer_T::continuation(text) } -> std::same_as<typename Lexer_T::Continuation>;
+    { Lexer_T::continue_token(c, text, from) } -> std::convertible_to<std::size_t>;
+    { c.kind != Lexer_T::Continuation::Kind::none } -> std::convertible_to<bool>;
+};
+
+struct NoContinuation {};
+
+template<typename Lexer_T>
+struct StreamContinuation {
+    using type = NoContinuation;
+};
+
+template<ContinuableLexer Lexer_T>
+struct StreamContinuation<Lexer_T> {
+    using type = typename Lexer_T::Continuation;
+};
+
+// Lexes input that arrives in chunks. Each call to feed() emits the tokens that
+// can no longer change and carries the unfinished tail (a partial identifier,
+// string, comment or continued macro line) over to the next chunk.
+//
+// A comment, string or macro line that spans chunks is scanned on from where the
+// last chunk ended, through the Continuation of Lexer_T, and lexed once more when
+// it ends. A lexer without one has the tail lexed again from its start with each
+// chunk. Its text stays whole in the buffer, so memory is the chunk size plus
+// the longest token: a comment over the whole input is held in memory entirely.
+//
+// Emitted offsets are relative to the start of the stream. Token text points
+// into an internal buffer and is only valid until the next feed() or finish().
+template<typename Lexer_T, typename Token_T>
+class StreamLexer {
+public:
+    using Error = typename Lexer_T::Error;
+
+    // the furthest any token decision looks past the end of the token
+    static constexpr std::size_t lookahead = 4;
+
+private:
+    Lexer_T m_lexer;
+    std::string m_buffer;
+    std::vector<Token_T> m_tokens;
+    std::vector<Error> m_errors;
+    std::size_t m_offset = 0;
+    std::size_t m_commit = 0;
+    // the tail is a token not ended yet, scanned up to m_scanned
+    [[no_unique_address]] typename StreamContinuation<Lexer_T>::type m_continuation;
+    std::size_t m_scanned = 0;
+    int m_line = 1;
+    int m_col = 1;
+    bool m_done = false;
+    bool m_failed = false;
+
+    void lex_buffer(bool final, std::vector<Token_T> &tokens, std::vector<Error> &errors) {
+        m_tokens.clear();
+        m_errors.clear();
+        m_lexer.lex(m_buffer, m_tokens, m_errors);
+
+        const std::size_t limit = m_buffer.size() > lookahead ? m_buffer.size() - lookahead : 0;
+        std::size_t commit = limit;
+        std::size_t count = m_tokens.size();
+
+        if(final) {
+            commit = m_buffer.size();
+        } else if(!m_errors.empty() && m_errors.front().end <= limit) {
+            m_done = true;
+            m_failed = true;
+            commit = m_buffer.size();
+        } else {
+            auto first = std::find_if(m_tokens.begin(), m_tokens.end(), [limit](const Token_T &t) { return t.end > limit; });
+            count = first - m_tokens.begin();
+
+            if(first != m_tokens.end()) {
+                commit = first->begin;
+            } else if(!m_errors.empty()) {
+                commit = m_errors.front().begin;
+            }
+
+            m_errors.clear();
+        }
+
+        for(std::size_t i = 0; i < count; i++) {
+            Token_T token = m_tokens[i];
+
+            if constexpr(LocatedToken<Token_T>) {
+                token.col = token.line == 1 ? token.col + m_col - 1 : token.col;
+                token.line += m_line - 1;
+            }
+
+            token.begin += m_offset;
+            token.end += m_offset;
+            tokens.push_back(token);
+        }
+
+        for(Error error : m_errors) {
+            error.begin += m_offset;
+            error.end += m_offset;
+            errors.push_back(std::move(error));
+        }
+
+        if constexpr(LocatedToken<Token_T>) {
+            for(std::size_t i = 0; i < commit; i++) {
+                if(m_buffer[i] == '\n') {
+                    m_line++;
+                    m_col = 1;
+                } else {
+                    m_col++;
+                }
+            }
+        }
+
+        m_offset += commit;
+        m_commit = commit;
+    }
+
+public:
+    void feed(std::string_view chunk, std::vector<Token_T> &tokens, std::vector<Error> &errors) {
+        if(m_done) {
+            return;
+        }
+
+        m_buffer.erase(0, m_commit);
+        m_commit = 0;
+        m_buffer.append(chunk);
+
+        if constexpr(ContinuableLexer<Lexer_T>) {
+            if(m_continuation.kind != Lexer_T::Continuation::Kind::none) {
+                if(Lexer_T::continue_token(m_continuation, m_buffer, m_scanned) == std::string_view::npos) {
+                    m_scanned = m_buffer.size();
+                    return;
+                }
+
+                m_continuation = {};
+            }
+        }
+
+        lex_buffer(false, tokens, errors);
+
+        if constexpr(ContinuableLexer<Lexer_T>) {
+            if(!m_done) {
+                m_continuation = Lexer_T::continuation(std::string_view(m_buffer).substr(m_commit));
+                m_scanned = m_buffer.size() - m_commit;
+            }
+        }
+    }
+
+    void finish(std::vector<Token_T> &tokens, std::vector<Error> &errors) {
+        if(m_done) {
+            return;
+        }
+
+        m_buffer.erase(0, m_commit);
+        m_commit = 0;
+        m_continuation = {};
+        lex_buffer(true, tokens, errors);
+        m_failed = !m_errors.empty();
+        m_done = true;
+    }
+
+    // a lexing error ended the stream, further input is ignored
+    [[nodiscard]] bool failed() const {
+        return m_failed;
+    }
+
+    [[nodiscard]] std::size_t offset() const {
+        return m_offset;
+    }
+};
+
+#endif
@@ -0,0 +1,213 @@
+#ifndef STRING_VALUE_H
+#define STRING_VALUE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+namespace string_value {
+
+inline int hex_value(char c) {
+    if(c >= '0' && c <= '9') {
+        return c - '0';
+    } else if(c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    } else if(c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+
+    return -1;
+}
+
+// up to max digits of base 8 or 16, or any number of them between braces
+inline std::uint32_t read_escape_number(const char *&p, const char *end, int base, std::size_t max) {
+    const bool braced = p < end && *p == '{';
+    std::uint32_t value = 0;
+
+    if(braced) {
+        p++;
+        max = ~std::size_t(0);
+    }
+
+    for(std::size_t i = 0; i < max && p < end; i++, p++) {
+        const int digit = hex_value(*p);
+
+        if(digit < 0 || digit >= base) {
+            break;
+        }
+
+        value = value * base + digit;
+    }
+
+    if(braced && p < end && *p == '}') {
+        p++;
+    }
+
+    return value;
+}
+
+inline void put_utf8(char *&out, std::uint32_t c) {
+    if(c < 0x80) {
+        *out++ = static_cast<char>(c);
+    } else if(c < 0x800) {
+        *out++ = static_cast<char>(0xC0 | c >> 6);
+        *out++ = static_cast<char>(0x80 | (c & 0x3F));
+    } else if(c < 0x10000) {
+        *out++ = static_cast<char>(0xE0 | c >> 12);
+        *out++ = static_cast<char>(0x80 | (c >> 6 & 0x3F));
+        *out++ = static_cast<char>(0x80 | (c & 0x3F));
+    } else {
+        c = std::min<std::uint32_t>(c, 0x10FFFF);
+        *out++ = static_cast<char>(0xF0 | c >> 18);
+        *out++ = static_cast<char>(0x80 | (c >> 12 & 0x3F));
+        *out++ = static_cast<char>(0x80 | (c >> 6 & 0x3F));
+        *out++ = static_cast<char>(0x80 | (c & 0x3F));
+    }
+}
+
+}
+
+// Decodes the escapes of body, the text between the quotes of a literal, into
+// out. An escape never decodes to more bytes than it is spelled with, so out
+// needs room for body.size() bytes. \u and \U become UTF-8, \x and octal escapes
+// a single byte. Returns the decoded length.
+inline std::size_t decode_escapes(std::string_view body, char *out) {
+    char *const first = out;
+    const char *p = body.data();
+    const char *const end = p + body.size();
+
+    while(p < end) {
+        const char *backslash = static_cast<const char *>(std::memchr(p, '\\', end - p));
+
+        if(!backslash) {
+            backslash = end;
+        }
+
+        std::memcpy(out, p, backslash - p);
+        out += backslash - p;
+        p = backslash;
+
+        if(end - p < 2) {
+            break;
+        }
+
+        p += 2;
+
+        switch(const char c = p[-1]) {
+        case 'a':
+            *out++ = '\a';
+            break;
+        case 'b':
+            *out++ = '\b';
+            break;
+        case 'f':
+            *out++ = '\f';
+            break;
+        case 'n':
+            *out++ = '\n';
+            break;
+        case 'r':
+            *out++ = '\r';
+            break;
+        case 't':
+            *out++ = '\t';
+            break;
+        case 'v':
+            *out++ = '\v';
+            break;
+        case 'x':
+            *out++ = static_cast<char>(string_value::read_escape_number(p, end, 16, ~std::size_t(0)));
+            break;
+        case 'o':
+            *out++ = static_cast<char>(string_value::read_escape_number(p, end, 8, ~std::size_t(0)));
+            break;
+        case 'u':
+            string_value::put_utf8(out, string_value::read_escape_number(p, end, 16, 4));
+            break;
+        case 'U':
+            string_value::put_utf8(out, string_value::read_escape_number(p, end, 16, 8));
+            break;
+        case '\r':
+            // a line continuation
+            p += p < end && *p == '\n';
+            break;
+        case '\n':
+            break;
+        default:
+            if(c >= '0' && c <= '7') {
+                p--;
+                *out++ = static_cast<char>(string_value::read_escape_number(p, end, 8, 3));
+            } else {
+                // \\, \', \", \? and unknown escapes stand for the character itself
+                *out++ = c;
+            }
+
+            break;
+        }
+    }
+
+    return out - first;
+}
+
+// Contents of the string and character literals of a stream, without quotes,
+// prefix or raw string delimiters, filled in by a lexer while it lexes. A literal
+// without escapes refers straight to the source, the others are decoded into an
+// arena the table owns. Contents stay valid until clear() and, for the ones that
+// refer to it, as long as the source. Token indices count from the first token
+// of the run, like BracketIndex.
+class StringValues {
+    std::pmr::monotonic_buffer_resource m_arena;
+    std::vector<std::uint32_t> m_tokens;
+    std::vector<std::string_view> m_values;
+    std::size_t m_decoded = 0;
+
+public:
+    void clear() {
+        m_tokens.clear();
+        m_values.clear();
+        m_arena.release();
+        m_decoded = 0;
+    }
+
+    // tokens must be added in increasing order
+    void add(std::size_t token, std::string_view value) {
+        m_tokens.push_back(static_cast<std::uint32_t>(token));
+        m_values.push_back(value);
+    }
+
+    // decodes body into the arena and adds the result
+    void add_decoded(std::size_t token, std::string_view body) {
+        char *out = static_cast<char *>(m_arena.allocate(std::max<std::size_t>(body.size(), 1), 1));
+        add(token, std::string_view(out, decode_escapes(body, out)));
+        m_decoded++;
+    }
+
+    // the contents of the literal token at index token, nullptr if it has none
+    [[nodiscard]] const std::string_view *find(std::size_t token) const {
+        auto it = std::lower_bound(m_tokens.begin(), m_tokens.end(), token);
+        return it != m_tokens.end() && *it == token ? &m_values[it - m_tokens.begin()] : nullptr;
+    }
+
+    [[nodiscard]] std::size_t size() const {
+        return m_values.size();
+    }
+
+    // how many literals had escapes and were copied
+    [[nodiscard]] std::size_t decoded() const {
+        return m_decoded;
+    }
+
+    [[nodiscard]] std::size_t token(std::size_t i) const {
+        return m_tokens[i];
+    }
+
+    [[nodiscard]] std::string_view value(std::size_t i) const {
+        return m_values[i];
+    }
+};
+
+#endif
@@ -0,0 +1,185 @@
+#ifndef TEST_LEXER_H
+#define TEST_LEXER_H
+
+#include <array>
+#include <string>
+#include <vector>
+#include <concepts>
+#include <type_traits>
+
+#include "BaseLexer.h"
+#include "CharClass.h"
+#include "NumberValue.h"
+#include "OperatorTable.h"
+
+struct Token {
+    enum class Kind {
+        identifier,
+        number,
+        string,
+        equals,
+        minus,
+        plus,
+        star,
+        star_star,
+        slash,
+        caret,
+        lparen,
+        rparen,
+        semicolon,
+    };
+
+    using value_type = Kind;
+
+    Kind value;
+    std::string_view text;
+    int line;
+    int col;
+    std::size_t begin;
+    std::size_t end;
+
+    static constexpr std::size_t index(Kind k) {
+        return static_cast<std::size_t>(k);
+    }
+
+    static constexpr const char *tokenKinds[] = {"identifier", "number", "string", "equals", "minus", "plus", "star", "star_star", "slash", "caret", "lparen", "rparen", "semicolon"};
+
+    static constexpr const char *name(Kind k) {
+        return tokenKinds[index(k)];
+    }
+
+    static constexpr auto operator_list = std::to_array<Operator<Kind>>({
+        {"=", Kind::equals},
+        {"-", Kind::minus},
+        {"+", Kind::plus},
+        {"*", Kind::star},
+        {"**", Kind::star_star},
+        {"/", Kind::slash},
+        {"^", Kind::caret},
+        {"(", Kind::lparen},
+        {")", Kind::rparen},
+        {";", Kind::semicolon},
+    });
+
+    static constexpr OperatorTable<Kind, operator_list.size()> operators{operator_list};
+};
+
+static_assert(Token::operators.ok());
+
+static_assert(std::is_trivially_copyable_v<Token>);
+
+class TestLexer : public BaseLexer<Token> {
+    NumberValues *m_numbers = nullptr;
+    bool m_floating = false;
+
+public:
+    // number tokens are decoded into numbers while lexing, nullptr turns it off
+    void set_number_values(NumberValues *numbers) {
+        m_numbers = numbers;
+    }
+
+    void lex(std::string_view str, std::vector<Token> &tokens, std::vector<Error> &errors) {
+        BaseLexer::lex(str, tokens, errors);
+
+        if(m_numbers) {
+            m_numbers->clear();
+        }
+
+        while(!end() && ok()) {
+            reset();
+
+            const char c = peek();
+            Token::Kind kind;
+
+            if(char_class::is(c, char_class::space)) {
+                skip_whitespace();
+            } else if(char_class::is(c, char_class::ident_start)) {
+                if(eat_identifier()) {
+                    make_token(Token::Kind::identifier);
+                }
+            } else if(c == '.' || char_class::is(c, char_class::digit)) {
+                advance();
+
+                if(eat_number()) {
+                    make_token(Token::Kind::number);
+
+                    if(m_numbers) {
+                        m_numbers->add(token_count() - 1, decode_number(get_string_view(), 10, m_floating));
+                    }
+                }
+            } else if(c == '"') {
+                advance();
+
+                if(eat_string()) {
+                    make_token(Token::Kind::string);
+                }
+            } else if(match_operator(Token::operators, kind)) {
+                make_token(kind);
+            } else {
+                advance();
+                add_error(ErrorCode::unhandled_character);
+                fail(true);
+            }
+        }
+    }
+
+    bool eat_identifier() {
+        while(char_class::is(peek(), char_class::ident_continue)) {
+            advance();
+        }
+
+        return true;
+    }
+
+    bool eat_number() {
+        m_floating = get_string_view()[0] == '.';
+
+        while(char_class::is(peek(), char_class::digit)) {
+            advance();
+        }
+
+        if(match('.')) {
+            m_floating = true;
+        }
+
+        while(char_class::is(peek(), char_class::digit)) {
+            advance();
+        }
+
+        if(check('e')) {
+            advance();
+            match('+', '-');
+            m_floating = true;
+
+            if(!char_class::is(peek(), char_class::digit)) {
+                add_error(ErrorCode::invalid_number);
+                fail(true);
+            } else {
+                while(char_class::is(peek(), char_class::digit)) {
+                    advance();
+                }
+            }
+        }
+
+        return ok();
+    }
+
+    bool eat_string() {
+        while(!end() && !check('"')) {
+            if(consume() == '\\' && !end()) {
+                advance();
+            }
+        }
+
+        if(end()) {
+            add_error(ErrorCode::unterminated_string);
+            fail(true);
+        } else {
+            advance();
+        }
+
+        return ok();
+    }
+};
+
+#endif
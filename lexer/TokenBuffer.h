@@ -0,0 +1,180 @@
+#ifndef TOKEN_BUFFER_H
+#define TOKEN_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string_view>
+#include <vector>
+
+template<typename Token_T>
+constexpr bool kinds_fit_in_byte() {
+    if constexpr(requires { Token_T::max_index_v; }) {
+        return Token_T::max_index_v <= std::numeric_limits<std::uint8_t>::max();
+    } else {
+        return true;
+    }
+}
+
+// Structure of arrays token storage, 9 bytes per token. Kinds are kept in their
+// own array so scanning for a kind only touches one byte per token. Tokens are
+// handed out by value, rebuilt from the arrays and the source they point into;
+// a Source hands out a Ref instead, which only reads the kind until it is
+// converted to a token. Offsets are 32 bit, so the source must be smaller than 4 GB.
+template<typename Token_T>
+class TokenBuffer {
+    static_assert(kinds_fit_in_byte<Token_T>());
+
+public:
+    using value_type = typename Token_T::value_type;
+
+    static constexpr std::size_t max_size = std::numeric_limits<std::uint32_t>::max();
+
+    // typical C++ averages 6-9 source bytes per token, dense expressions less.
+    // Reserving for too many tokens costs less than growing every array once.
+    static constexpr std::size_t bytes_per_token_estimate = 4;
+
+private:
+    std::string_view m_source;
+    std::vector<std::uint8_t> m_kinds;
+    std::vector<std::uint32_t> m_begins;
+    std::vector<std::uint32_t> m_lengths;
+
+public:
+    struct Ref {
+        value_type value;
+        std::uint32_t index;
+        const TokenBuffer *buffer;
+
+        [[nodiscard]] std::size_t begin() const {
+            return buffer->begin(index);
+        }
+
+        [[nodiscard]] std::size_t end() const {
+            return buffer->end(index);
+        }
+
+        [[nodiscard]] std::string_view text() const {
+            return buffer->text(index);
+        }
+
+        operator Token_T() const {
+            return (*buffer)[index];
+        }
+    };
+
+    class Source {
+        const TokenBuffer *m_buffer;
+        std::size_t m_index = 0;
+
+    public:
+        explicit Source(const TokenBuffer &buffer) : m_buffer(&buffer) {}
+
+        [[nodiscard]] Ref peek() const {
+            return m_buffer->ref(m_index);
+        }
+
+        Ref consume() {
+            return m_buffer->ref(m_index++);
+        }
+
+        [[nodiscard]] bool end() const {
+            return m_index >= m_buffer->size();
+        }
+    };
+
+    void clear() {
+        m_kinds.clear();
+        m_begins.clear();
+        m_lengths.clear();
+    }
+
+    void reserve(std::size_t tokens) {
+        m_kinds.reserve(tokens);
+        m_begins.reserve(tokens);
+        m_lengths.reserve(tokens);
+    }
+
+    // room for the tokens of source_size more bytes
+    void reserve_for(std::size_t source_size) {
+        reserve(size() + source_size / bytes_per_token_estimate + 16);
+    }
+
+    void set_source(std::string_view source) {
+        m_source = source;
+    }
+
+    void push_back(value_type value, std::size_t begin, std::size_t end) {
+        m_kinds.push_back(static_cast<std::uint8_t>(Token_T::index(value)));
+        m_begins.push_back(static_cast<std::uint32_t>(begin));
+        m_lengths.push_back(static_cast<std::uint32_t>(end - begin));
+    }
+
+    [[nodiscard]] std::size_t size() const {
+        return m_kinds.size();
+    }
+
+    [[nodiscard]] bool empty() const {
+        return m_kinds.empty();
+    }
+
+    [[nodiscard]] value_type kind(std::size_t i) const {
+        return static_cast<value_type>(m_kinds[i]);
+    }
+
+    [[nodiscard]] std::span<const std::uint8_t> kinds() const {
+        return m_kinds;
+    }
+
+    [[nodiscard]] std::size_t begin(std::size_t i) const {
+        return m_begins[i];
+    }
+
+    [[nodiscard]] std::size_t end(std::size_t i) const {
+        return static_cast<std::size_t>(m_begins[i]) + m_lengths[i];
+    }
+
+    [[nodiscard]] std::string_view text(std::size_t i) const {
+        return m_source.substr(m_begins[i], m_lengths[i]);
+    }
+
+    [[nodiscard]] Token_T operator[](std::size_t i) const {
+        return {.value = kind(i), .text = text(i), .begin = begin(i), .end = end(i)};
+    }
+
+    [[nodiscard]] Ref ref(std::size_t i) const {
+        return {kind(i), static_cast<std::uint32_t>(i), this};
+    }
+
+    // the tokens of one kind, counted in blocks of 64 that the compiler vectorizes
+    [[nodiscard]] std::size_t count(value_type value) const {
+        const auto kind = static_cast<std::uint8_t>(Token_T::index(value));
+        const std::uint8_t *kinds = m_kinds.data();
+        const std::size_t blocks = size() - size() % 64;
+        std::size_t count = 0;
+
+        for(std::size_t i = 0; i < blocks; i += 64) {
+            std::uint8_t block = 0;
+
+            for(std::size_t j = 0; j < 64; j++) {
+                block += kinds[i + j] == kind;
+            }
+
+            count += block;
+        }
+
+        for(std::size_t i = blocks; i < size(); i++) {
+            count += kinds[i] == kind;
+        }
+
+        return count;
+    }
+
+    // bytes taken by the tokens, spare capacity not included
+    [[nodiscard]] std::size_t memory_usage() const {
+        return size() * (sizeof(std::uint8_t) + 2 * sizeof(std::uint32_t));
+    }
+};
+
+#endif
@@ -0,0 +1,281 @@
+#ifndef TOKEN_CACHE_H
+#define TOKEN_CACHE_H
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include <unistd.h>
+
+#include "BaseLexer.h"
+#include "SourceBuffer.h"
+#include "TokenBuffer.h"
+
+// XXH64, a few times faster than byte at a time hashes on large inputs, so a
+// warm cache is limited by reading the file rather than by hashing it
+inline std::uint64_t content_hash(std::string_view data, std::uint64_t seed = 0) {
+    constexpr std::uint64_t p1 = 0x9e3779b185ebca87;
+    constexpr std::uint64_t p2 = 0xc2b2ae3d27d4eb4f;
+    constexpr std::uint64_t p3 = 0x165667b19e3779f9;
+    constexpr std::uint64_t p4 = 0x85ebca77c2b2ae63;
+    constexpr std::uint64_t p5 = 0x27d4eb2f165667c5;
+
+    auto read64 = [](const char *p) { std::uint64_t v; std::memcpy(&v, p, 8); return v; };
+    auto read32 = [](const char *p) { std::uint32_t v; std::memcpy(&v, p, 4); return v; };
+    auto round = [](std::uint64_t acc, std::uint64_t lane) { return std::rotl(acc + lane * p2, 31) * p1; };
+    auto merge = [&round](std::uint64_t h, std::uint64_t acc) { return (h ^ round(0, acc)) * p1 + p4; };
+
+    const char *p = data.data();
+    const char *const end = p + data.size();
+    std::uint64_t h;
+
+    if(data.size() >= 32) {
+        std::uint64_t v1 = seed + p1 + p2, v2 = seed + p2, v3 = seed, v4 = seed - p1;
+
+        for(; end - p >= 32; p += 32) {
+            v1 = round(v1, read64(p));
+            v2 = round(v2, read64(p + 8));
+            v3 = round(v3, read64(p + 16));
+            v4 = round(v4, read64(p + 24));
+        }
+
+        h = std::rotl(v1, 1) + std::rotl(v2, 7) + std::rotl(v3, 12) + std::rotl(v4, 18);
+        h = merge(merge(merge(merge(h, v1), v2), v3), v4);
+    } else {
+        h = seed + p5;
+    }
+
+    h += data.size();
+
+    for(; end - p >= 8; p += 8) {
+        h = std::rotl(h ^ round(0, read64(p)), 27) * p1 + p4;
+    }
+
+    if(end - p >= 4) {
+        h = std::rotl(h ^ (read32(p) * p1), 23) * p2 + p3;
+        p += 4;
+    }
+
+    for(; p < end; p++) {
+        h = std::rotl(h ^ (static_cast<unsigned char>(*p) * p5), 11) * p1;
+    }
+
+    h = (h ^ (h >> 33)) * p2;
+    h = (h ^ (h >> 29)) * p3;
+    return h ^ (h >> 32);
+}
+
+// On-disk cache of token streams, keyed by a hash of the source and a stamp of
+// the lexer that produced them, so identical files anywhere share one entry.
+// Entries hold the kinds and offsets of the tokens and the errors, text is
+// rebuilt from the source on load. Symbols are not stored, lex() interns them
+// again on a hit.
+//
+// An entry is written to a temporary file and renamed into place, so
+// concurrent writers and readers never see a partial entry.
+template<typename Lexer_T, typename Token_T> requires OffsetToken<Token_T>
+class TokenCache {
+    static_assert(kinds_fit_in_byte<Token_T>());
+
+public:
+    using Error = typename Lexer_T::Error;
+
+private:
+    static constexpr std::uint32_t magic = 0x434b4f54; // "TOKC"
+    static constexpr std::uint32_t format_version = 3;
+
+    struct Header {
+        std::uint32_t magic;
+        std::uint32_t format;
+        std::uint64_t stamp;
+        std::uint64_t source_size;
+        std::uint64_t source_hash;
+        std::uint64_t tokens;
+        std::uint64_t errors;
+    };
+
+    struct StoredError {
+        std::uint32_t code;
+        std::uint32_t begin;
+        std::uint32_t end;
+    };
+
+    std::filesystem::path m_directory;
+    // the lexer configuration and kind table the entries are for
+    std::uint64_t m_stamp;
+
+    static std::uint64_t stamp(const Lexer_T &lexer) {
+        const std::uint64_t parts[] = {lexer.cache_stamp(), Token_T::max_index_v};
+        return content_hash(std::string_view(reinterpret_cast<const char *>(parts), sizeof(parts)));
+    }
+
+    [[nodiscard]] std::filesystem::path entry_path(std::uint64_t hash, std::size_t size) const {
+        char name[64];
+        std::snprintf(name, sizeof(name), "%016llx-%llx.tok", static_cast<unsigned long long>(hash), static_cast<unsigned long long>(size));
+        return m_directory / name;
+    }
+
+    static std::size_t entry_size(std::size_t tokens, std::size_t errors) {
+        return sizeof(Header) + tokens * (1 + 2 * sizeof(std::uint32_t)) + errors * sizeof(StoredError);
+    }
+
+public:
+    // entries are for lexers configured like lexer, tokens passed to store() must
+    // come from one
+    TokenCache(std::filesystem::path directory, const Lexer_T &lexer) :
+        m_directory(std::move(directory)), m_stamp(stamp(lexer)) {}
+
+    // creates the cache directory if needed
+    bool open() {
+        std::error_code ec;
+        std::filesystem::create_directories(m_directory, ec);
+        return std::filesystem::is_directory(m_directory, ec);
+    }
+
+    [[nodiscard]] std::uint64_t key(std::string_view source) const {
+        return content_hash(source, m_stamp);
+    }
+
+    // fills tokens and errors from the cache entry for source, false on a miss. Tokens
+    // get no symbols
+    bool load(std::string_view source, std::uint64_t key, std::vector<Token_T> &tokens, std::vector<Error> &errors) const {
+        SourceBuffer entry;
+
+        if(!entry.open(entry_path(key, source.size()).c_str())) {
+            return false;
+        }
+
+        const std::string_view data = entry.view();
+        Header header;
+
+        if(data.size() < sizeof(Header)) {
+            return false;
+        }
+
+        std::memcpy(&header, data.data(), sizeof(Header));
+
+        if(header.magic != magic || header.format != format_version || header.stamp != m_stamp || header.source_size != source.size() || header.source_hash != key
+            || header.tokens > data.size() || header.errors > data.size() || data.size() != entry_size(header.tokens, header.errors)) {
+            return false;
+        }
+
+        const char *kinds = data.data() + sizeof(Header);
+        const char *begins = kinds + header.tokens;
+        const char *lengths = begins + header.tokens * sizeof(std::uint32_t);
+        const char *stored_errors = lengths + header.tokens * sizeof(std::uint32_t);
+        const std::size_t first = tokens.size();
+
+        tokens.resize(first + header.tokens);
+
+        for(std::size_t i = 0; i < header.tokens; i++) {
+            std::uint32_t begin, length;
+            std::memcpy(&begin, begins + i * sizeof(std::uint32_t), sizeof(std::uint32_t));
+            std::memcpy(&length, lengths + i * sizeof(std::uint32_t), sizeof(std::uint32_t));
+
+            if(static_cast<std::size_t>(begin) + length > source.size() || static_cast<unsigned char>(kinds[i]) > Token_T::max_index_v) {
+                tokens.resize(first);
+                return false;
+            }
+
+            tokens[first + i] = {.value = static_cast<typename Token_T::value_type>(static_cast<unsigned char>(kinds[i])), .text = source.substr(begin, length), .begin = begin, .end = static_cast<std::size_t>(begin) + length};
+        }
+
+        for(std::size_t i = 0; i < header.errors; i++) {
+            StoredError error;
+            std::memcpy(&error, stored_errors + i * sizeof(StoredError), sizeof(StoredError));
+            errors.push_back({static_cast<ErrorCode>(error.code), error.begin, error.end});
+        }
+
+        return true;
+    }
+
+    // writes the entry for source, tokens and errors must be the complete result of lexing it
+    bool store(std::string_view source, std::uint64_t key, const std::vector<Token_T> &tokens, const std::vector<Error> &errors) const {
+        if(source.size() > TokenBuffer<Token_T>::max_size) {
+            return false;
+        }
+
+        std::string data(entry_size(tokens.size(), errors.size()), '\0');
+        const Header header{magic, format_version, m_stamp, source.size(), key, tokens.size(), errors.size()};
+        std::memcpy(data.data(), &header, sizeof(Header));
+
+        char *kinds = data.data() + sizeof(Header);
+        char *begins = kinds + tokens.size();
+        char *lengths = begins + tokens.size() * sizeof(std::uint32_t);
+        char *stored_errors = lengths + tokens.size() * sizeof(std::uint32_t);
+
+        for(std::size_t i = 0; i < tokens.size(); i++) {
+            const auto begin = static_cast<std::uint32_t>(tokens[i].begin);
+            const auto length = static_cast<std::uint32_t>(tokens[i].end - tokens[i].begin);
+            kinds[i] = static_cast<char>(Token_T::index(tokens[i].value));
+            std::memcpy(begins + i * sizeof(std::uint32_t), &begin, sizeof(std::uint32_t));
+            std::memcpy(lengths + i * sizeof(std::uint32_t), &length, sizeof(std::uint32_t));
+        }
+
+        for(std::size_t i = 0; i < errors.size(); i++) {
+            const StoredError error{static_cast<std::uint32_t>(errors[i].code), static_cast<std::uint32_t>(errors[i].begin), static_cast<std::uint32_t>(errors[i].end)};
+            std::memcpy(stored_errors + i * sizeof(StoredError), &error, sizeof(StoredError));
+        }
+
+        static std::atomic<unsigned> counter = 0;
+        const std::filesystem::path path = entry_path(key, source.size());
+        std::filesystem::path temporary = path;
+        temporary += "." + std::to_string(::getpid()) + "-" + std::to_string(counter.fetch_add(1)) + ".tmp";
+
+        std::FILE *file = std::fopen(temporary.c_str(), "wb");
+
+        if(!file) {
+            return false;
+        }
+
+        bool ok = std::fwrite(data.data(), 1, data.size(), file) == data.size();
+        ok = std::fclose(file) == 0 && ok;
+
+        std::error_code ec;
+
+        if(ok) {
+            std::filesystem::rename(temporary, path, ec);
+        }
+
+        if(!ok || ec) {
+            std::filesystem::remove(temporary, ec);
+            return false;
+        }
+
+        return true;
+    }
+
+    // loads the tokens for source, or lexes them with lexer and stores them. A lexer
+    // configured unlike the one the cache was made for only lexes. tokens and errors
+    // are expected to be empty. returns true on a hit
+    bool lex(Lexer_T &lexer, std::string_view source, std::vector<Token_T> &tokens, std::vector<Error> &errors) const {
+        if(stamp(lexer) != m_stamp) {
+            lexer.lex(source, tokens, errors);
+            return false;
+        }
+
+        const std::uint64_t hash = key(source);
+
+        if(load(source, hash, tokens, errors)) {
+            if constexpr(requires { lexer.intern_symbols(tokens); }) {
+                lexer.intern_symbols(tokens);
+            }
+
+            return true;
+        }
+
+        lexer.lex(source, tokens, errors);
+        store(source, hash, tokens, errors);
+        return false;
+    }
+};
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef TOKEN_CURSOR_H
+#define TOKEN_CURSOR_H
+
+// One token of lookahead over a lexer in pull mode, the lexer must already have
+// been started. Matches the peek()/consume()/end() interface PrattParser reads
+// tokens through.
+template<typename Lexer_T, typename Token_T>
+class TokenCursor {
+    Lexer_T *m_lexer;
+    Token_T m_token{};
+    bool m_has_token = false;
+
+    void fill() {
+        m_has_token = m_lexer->next_token(m_token);
+    }
+
+public:
+    explicit TokenCursor(Lexer_T &lexer) : m_lexer(&lexer) {
+        fill();
+    }
+
+    [[nodiscard]] const Token_T &peek() const {
+        return m_token;
+    }
+
+    Token_T consume() {
+        Token_T token = m_token;
+        fill();
+        return token;
+    }
+
+    [[nodiscard]] bool end() const {
+        return !m_has_token;
+    }
+};
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef TOKEN_VIEW_H
+#define TOKEN_VIEW_H
+
+#include <bitset>
+#include <cstddef>
+#include <initializer_list>
+#include <ranges>
+
+// A set of token kinds, one bit per kind.
+template<typename Token_T>
+class KindSet {
+    std::bitset<Token_T::max_index_v + 1> m_bits;
+
+public:
+    using value_type = typename Token_T::value_type;
+
+    KindSet() = default;
+
+    KindSet(std::initializer_list<value_type> kinds) {
+        for(auto kind : kinds) {
+            m_bits.set(Token_T::index(kind));
+        }
+    }
+
+    [[nodiscard]] bool contains(value_type kind) const {
+        return m_bits.test(Token_T::index(kind));
+    }
+
+    [[nodiscard]] KindSet operator~() const {
+        KindSet complement;
+        complement.m_bits = ~m_bits;
+        return complement;
+    }
+};
+
+// Lazy views over a range of tokens that keep or drop some kinds, nothing is
+// copied. The range must outlive the view.
+template<std::ranges::viewable_range Range_T, typename Token_T = std::ranges::range_value_t<Range_T>>
+auto only_kinds(Range_T &&tokens, KindSet<Token_T> kinds) {
+    return std::views::filter(std::forward<Range_T>(tokens), [kinds](const Token_T &token) { return kinds.contains(token.value); });
+}
+
+template<std::ranges::viewable_range Range_T, typename Token_T = std::ranges::range_value_t<Range_T>>
+auto without_kinds(Range_T &&tokens, KindSet<Token_T> kinds) {
+    return only_kinds(std::forward<Range_T>(tokens), ~kinds);
+}
+
+// Wraps a peek()/consume()/end() token source and steps over the tokens of
+// some kinds, so a parser only sees the ones it cares about.
+template<typename Source_T, typename Token_T>
+class FilteredSource {
+    Source_T *m_source;
+    KindSet<Token_T> m_skip;
+
+    void skip() {
+        while(!m_source->end() && m_skip.contains(m_source->peek().value)) {
+            m_source->consume();
+        }
+    }
+
+public:
+    FilteredSource(Source_T &source, KindSet<Token_T> skip) : m_source(&source), m_skip(skip) {
+        this->skip();
+    }
+
+    [[nodiscard]] decltype(auto) peek() const {
+        return m_source->peek();
+    }
+
+    auto consume() {
+        auto token = m_source->consume();
+        skip();
+        return token;
+    }
+
+    [[nodiscard]] bool end() const {
+        return m_source->end();
+    }
+};
+
+#endif
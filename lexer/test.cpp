@@ -0,0 +1,90 @@
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "SourceBuffer.h"
+#include "StreamLexer.h"
+#include "TestLexer.h"
+
+// Checks the generic drivers with TestLexer, which has none of the hooks that
+// cpp_lexer::Lexer provides for them. Exits with 1 if any check fails.
+
+static int g_failures = 0;
+
+void check(const char *name, bool ok) {
+    std::printf("%s %s\n", ok ? "ok    " : "FAILED", name);
+    g_failures += !ok;
+}
+
+// lexes code in chunks of chunk_size bytes and checks the result against the whole-buffer tokens
+bool check_stream(std::string_view code, std::size_t chunk_size) {
+    TestLexer lexer;
+    std::vector<Token> expected;
+    std::vector<TestLexer::Error> expected_errors;
+    lexer.lex(code, expected, expected_errors);
+
+    StreamLexer<TestLexer, Token> stream;
+    std::vector<Token> chunk_tokens;
+    std::vector<TestLexer::Error> errors;
+    std::size_t index = 0;
+
+    // token text is only valid until the next feed()
+    auto compare = [&]() {
+        for(const auto &token : chunk_tokens) {
+            const Token *other = index < expected.size() ? &expected[index] : nullptr;
+
+            if(!other || token.value != other->value || token.begin != other->begin || token.end != other->end || token.text != other->text || token.line != other->line || token.col != other->col) {
+                std::printf("stream mismatch at token %zu with %zu byte chunks\n", index, chunk_size);
+                return false;
+            }
+
+            index++;
+        }
+
+        chunk_tokens.clear();
+        return true;
+    };
+
+    for(std::size_t offset = 0; offset < code.size(); offset += chunk_size) {
+        stream.feed(code.substr(offset, chunk_size), chunk_tokens, errors);
+
+        if(!compare()) {
+            return false;
+        }
+    }
+
+    stream.finish(chunk_tokens, errors);
+    return compare() && index == expected.size() && errors.size() == expected_errors.size();
+}
+
+int main(int argc, char **argv) {
+    if(argc < 2) {
+        std::fprintf(stderr, "usage: %s <file>\n", argv[0]);
+        return 1;
+    }
+
+    SourceBuffer source;
+
+    if(!source.open(argv[1])) {
+        std::fprintf(stderr, "failed to read %s\n", argv[1]);
+        return 1;
+    }
+
+    const std::string long_string = "a = \"" + std::string(10000, 'x') + "\\\"\";\nb = 1.5e-3;\n";
+    bool ok = true;
+
+    for(std::size_t chunk_size : {1, 3, 7, 64, 4096}) {
+        ok = ok && check_stream(source.view(), chunk_size) && check_stream(long_string, chunk_size);
+    }
+
+    check("stream matches whole-buffer lexing", ok);
+    check("stream reports an unterminated string", check_stream("a = \"abc\\", 3));
+
+    if(g_failures) {
+        std::printf("%d checks failed\n", g_failures);
+        return 1;
+    }
+
+    return 0;
+}
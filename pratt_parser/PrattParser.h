@@ -17,7 +17,35 @@ concept IndexableToken = requires(T a) {
 template<typename T>
 concept MovableExpression = std::move_constructible<T>;
 
-template<IndexableToken Token_T, MovableExpression Expression_T>
+template<typename T, typename Token_T>
+concept TokenSource = requires(T a, const T b) {
+    { a.consume() } -> std::convertible_to<const Token_T &>;
+    { b.peek() } -> std::convertible_to<const Token_T &>;
+    { b.end() } -> std::convertible_to<bool>;
+};
+
+template<typename Token_T>
+class VectorTokenSource {
+    const std::vector<Token_T> *m_tokens;
+    std::size_t *m_index;
+
+public:
+    VectorTokenSource(const std::vector<Token_T> &tokens, std::size_t &index) : m_tokens(&tokens), m_index(&index) {}
+
+    const Token_T &consume() {
+        return m_tokens->at((*m_index)++);
+    }
+
+    [[nodiscard]] const Token_T &peek() const {
+        return m_tokens->at(*m_index);
+    }
+
+    bool end() const {
+        return *m_index == m_tokens->size();
+    }
+};
+
+template<IndexableToken Token_T, MovableExpression Expression_T, TokenSource<Token_T> Source_T = VectorTokenSource<Token_T>>
 class PrattParser {
 public:
     using PrefixParselet_t = Expression_T (*)(int precedence, const Token_T &, PrattParser &parser);
@@ -36,8 +64,7 @@ private:
 
     std::array<PrefixParselet, Token_T::max_index_v + 1> m_prefixParselets;
     std::array<InfixParselet, Token_T::max_index_v + 1> m_infixParselets;
-    const std::vector<Token_T> *m_tokens{};
-    std::size_t *m_index = nullptr;
+    Source_T *m_source = nullptr;
 
     int getPrecedence(typename Token_T::value_type value) const {
         if(Token_T::index(value) < m_infixParselets.size()) {
@@ -48,12 +75,16 @@ private:
     }
 
 public:
-    Expression_T parseExpression(const std::vector<Token_T> &tokens, std::size_t &index) {
-        m_index = &index;
-        m_tokens = &tokens;
+    Expression_T parseExpression(Source_T &source) {
+        m_source = &source;
         return parse();
     }
 
+    Expression_T parseExpression(const std::vector<Token_T> &tokens, std::size_t &index) requires std::same_as<Source_T, VectorTokenSource<Token_T>> {
+        Source_T source(tokens, index);
+        return parseExpression(source);
+    }
+
     void addPrefixParselet(typename Token_T::value_type value, int precedence, PrefixParselet_t prefixParselet) {
         m_prefixParselets[Token_T::index(value)] = {precedence, prefixParselet};
     }
@@ -94,16 +125,17 @@ public:
         return left;
     }
 
-    const Token_T &consume() {
-        return m_tokens->at((*m_index)++);
+    // a reference for sources that own their tokens, a copy for ones that lex on demand
+    decltype(auto) consume() {
+        return m_source->consume();
     }
 
-    [[nodiscard]] const Token_T &peek() const {
-        return m_tokens->at(*m_index);
+    [[nodiscard]] decltype(auto) peek() const {
+        return m_source->peek();
     }
 
     bool end() const {
-        return *m_index == m_tokens->size();
+        return m_source->end();
     }
 };
 
@@ -31,7 +31,7 @@ struct UnaryExpression : public Expression {
     };
 
     [[nodiscard]] std::string toString() const override {
-        return "("s + std::string(name()) + " "s + oper.text + " "s + right->toString() + ")"s;
+        return "("s + std::string(name()) + " "s + std::string(oper.text) + " "s + right->toString() + ")"s;
     }
 };
 
@@ -48,7 +48,7 @@ struct GroupExpression : public Expression {
     };
 
     [[nodiscard]] std::string toString() const override {
-        return "("s + std::string(name()) + " "s + token.text + expr->toString() + ")"s;
+        return "("s + std::string(name()) + " "s + std::string(token.text) + expr->toString() + ")"s;
     }
 };
 
@@ -65,7 +65,7 @@ struct PostfixExpression : public Expression {
     };
 
     [[nodiscard]] std::string toString() const override {
-        return "("s + std::string(name()) + " "s + left->toString() + " "s + oper.text + ")"s;
+        return "("s + std::string(name()) + " "s + left->toString() + " "s + std::string(oper.text) + ")"s;
     }
 };
 
@@ -83,7 +83,7 @@ struct BinaryExpression : public Expression {
     };
 
     [[nodiscard]] std::string toString() const override {
-        return "("s + std::string(name()) + " " + left->toString() + " " + oper.text + " " + right->toString() + ")";
+        return "("s + std::string(name()) + " " + left->toString() + " " + std::string(oper.text) + " " + right->toString() + ")";
     }
 };
 
@@ -99,7 +99,7 @@ struct NumberExpression : public Expression {
     };
 
     [[nodiscard]] std::string toString() const override {
-        return token.text;
+        return std::string(token.text);
     }
 };
 
@@ -115,7 +115,7 @@ struct NameExpression : public Expression {
     };
 
     [[nodiscard]] std::string toString() const override {
-        return token.text;
+        return std::string(token.text);
     }
 };
 
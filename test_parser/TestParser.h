@@ -21,22 +21,7 @@ class TestParser : public BaseParser<cpp_lexer::Token> {
 
 public:
     TestParser() {
-        m_parser.addInfixParselet(Token::value_type::equal, 1, binaryParselet);
-
-        m_parser.addInfixParselet(Token::value_type::plus, 2, binaryParselet);
-        m_parser.addInfixParselet(Token::value_type::plus, 2, binaryParselet);
-
-        m_parser.addInfixParselet(Token::value_type::star, 3, binaryParselet);
-        m_parser.addInfixParselet(Token::value_type::slash, 3, binaryParselet);
-        m_parser.addInfixParselet(Token::value_type::bang, 3, postfixParselet);
-
-        m_parser.addPrefixParselet(Token::value_type::plus, 4, unaryParselet);
-        m_parser.addPrefixParselet(Token::value_type::minus, 4, unaryParselet);
-        m_parser.addPrefixParselet(Token::value_type::bang, 4, unaryParselet);
-
-        m_parser.addPrefixParselet(Token::value_type::identifier, 0, primaryParselet);
-        m_parser.addPrefixParselet(Token::value_type::number, 0, primaryParselet);
-        m_parser.addPrefixParselet(Token::value_type::lparen, 0, groupingParselet);
+        addParselets(m_parser);
     }
 
     void parse(const std::vector<Token> &tokens) {
@@ -52,8 +37,48 @@ public:
         }
     }
 
+    // for sources that produce tokens by value, like a TokenCursor that lexes
+    // while parsing or a TokenBuffer::Source
+    template<TokenSource<Token> Source_T>
+    void parse(Source_T &source) {
+        PrattParser<Token, std::unique_ptr<Expression>, Source_T> parser;
+        addParselets(parser);
+
+        while(!source.end()) {
+            auto expr = parser.parseExpression(source);
+
+            if(source.end() || source.peek().value != Token::value_type::semicolon) {
+                std::printf("error: expected ;\n");
+                return;
+            }
+
+            source.consume();
+        }
+    }
+
 private:
-    static std::unique_ptr<Expression> primaryParselet(int, const Token &token, ExpressionParser &) {
+    template<typename Parser_T>
+    static void addParselets(Parser_T &parser) {
+        parser.addInfixParselet(Token::value_type::equal, 1, binaryParselet);
+
+        parser.addInfixParselet(Token::value_type::plus, 2, binaryParselet);
+        parser.addInfixParselet(Token::value_type::plus, 2, binaryParselet);
+
+        parser.addInfixParselet(Token::value_type::star, 3, binaryParselet);
+        parser.addInfixParselet(Token::value_type::slash, 3, binaryParselet);
+        parser.addInfixParselet(Token::value_type::bang, 3, postfixParselet);
+
+        parser.addPrefixParselet(Token::value_type::plus, 4, unaryParselet);
+        parser.addPrefixParselet(Token::value_type::minus, 4, unaryParselet);
+        parser.addPrefixParselet(Token::value_type::bang, 4, unaryParselet);
+
+        parser.addPrefixParselet(Token::value_type::identifier, 0, primaryParselet);
+        parser.addPrefixParselet(Token::value_type::number, 0, primaryParselet);
+        parser.addPrefixParselet(Token::value_type::lparen, 0, groupingParselet);
+    }
+
+    template<typename Parser_T>
+    static std::unique_ptr<Expression> primaryParselet(int, const Token &token, Parser_T &) {
         if(token.value == Token::value_type::identifier) {
             return std::make_unique<NameExpression>(token);
         } else {
@@ -61,7 +86,8 @@ private:
         }
     }
 
-    static std::unique_ptr<Expression> unaryParselet(int precedence, const Token &token, ExpressionParser &parser) {
+    template<typename Parser_T>
+    static std::unique_ptr<Expression> unaryParselet(int precedence, const Token &token, Parser_T &parser) {
         auto right = parser.parse(precedence);
 
         if (!right) {
@@ -70,11 +96,12 @@ private:
         }
 
         auto ret = std::make_unique<UnaryExpression>(token, std::move(right));
-        std::puts(token.text.c_str());
+        std::printf("%.*s\n", static_cast<int>(token.text.size()), token.text.data());
         return ret;
     }
 
-    static std::unique_ptr<Expression> groupingParselet(int, const Token &token, ExpressionParser &parser) {
+    template<typename Parser_T>
+    static std::unique_ptr<Expression> groupingParselet(int, const Token &token, Parser_T &parser) {
         auto right = parser.parse();
 
         if (!right) {
@@ -90,9 +117,10 @@ private:
 
         parser.consume();
         return std::make_unique<GroupExpression>(token, std::move(right));
-    };
+    }
 
-    static std::unique_ptr<Expression> binaryParselet(int precedence, std::unique_ptr<Expression> left, const Token &token, ExpressionParser &parser) {
+    template<typename Parser_T>
+    static std::unique_ptr<Expression> binaryParselet(int precedence, std::unique_ptr<Expression> left, const Token &token, Parser_T &parser) {
         auto right = parser.parse(precedence);
 
         if(!right) {
@@ -101,11 +129,12 @@ private:
         }
 
         return std::make_unique<BinaryExpression>(std::move(left), token, std::move(right));
-    };
+    }
 
-    static std::unique_ptr<Expression> postfixParselet(int, std::unique_ptr<Expression> left, const Token &token, ExpressionParser &) {
+    template<typename Parser_T>
+    static std::unique_ptr<Expression> postfixParselet(int, std::unique_ptr<Expression> left, const Token &token, Parser_T &) {
         return std::make_unique<PostfixExpression>(std::move(left), token);
-    };
+    }
 
 
     template<typename ...Args> requires ((std::convertible_to<Args, std::string_view>) && ...)
@@ -2,50 +2,74 @@
 #include <string>
 #include <cstdio>
 #include <vector>
-#include <fstream>
 #include <concepts>
 
 #include "TestParser.h"
+#include "lexer/TokenCursor.h"
+#include "lexer/LineIndex.h"
+#include "lexer/SourceBuffer.h"
 
 using namespace std::literals;
 
-std::string readFile(const char *filename) {
-    std::ifstream f(filename);
+// prints each token as the parser pulls it from the lexer
+class PrintingCursor {
+    TokenCursor<cpp_lexer::Lexer, cpp_lexer::Token> m_cursor;
 
-    if(!f.good()) {
-        return "";
+public:
+    explicit PrintingCursor(cpp_lexer::Lexer &lexer) : m_cursor(lexer) {
     }
 
-    f.seekg(0, std::ios::end);
-    std::size_t size = f.tellg();
-    f.seekg(0, std::ios::beg);
-    std::string str(size, '\0');
-    f.read(str.data(), size);
-    return str;
-}
+    [[nodiscard]] const cpp_lexer::Token &peek() const {
+        return m_cursor.peek();
+    }
+
+    cpp_lexer::Token consume() {
+        cpp_lexer::Token token = m_cursor.consume();
+        std::printf("token: %s (%.*s)\n", cpp_lexer::Token::name(token.value), static_cast<int>(token.text.size()), token.text.data());
+        return token;
+    }
+
+    [[nodiscard]] bool end() const {
+        return m_cursor.end();
+    }
+};
+
+int main(int argc, char **argv) {
+    if(argc < 2) {
+        std::fprintf(stderr, "usage: %s <file>\n", argv[0]);
+        return 1;
+    }
 
-int main(int, char **argv) {
-    cpp_lexer::Lexer lexer;
-    std::vector<cpp_lexer::Token> tokens;
     std::vector<cpp_lexer::Lexer::Error> errors;
-    std::string code = readFile(argv[1]);
+    SourceBuffer source;
+
+    if(!source.open(argv[1])) {
+        std::fprintf(stderr, "failed to read %s\n", argv[1]);
+        return 1;
+    }
+
+    std::string_view code = source.view();
 
-    lexer.lex(code, tokens, errors);
+    // the parser only wants significant tokens, so trivia never becomes tokens
+    cpp_lexer::Lexer lexer;
+    lexer.set_skip_comments(true);
+    lexer.set_skip_macros(true);
+    lexer.start(code, errors);
+    PrintingCursor cursor(lexer);
+
+    TestParser parser;
+    parser.parse(cursor);
 
     if(!errors.empty()) {
+        LineIndex lines(code);
+
         for(const auto &error : errors) {
-            std::printf("error on line: %d, col: %d: %s (%s)\n", error.line, error.col, error.error.c_str(), error.text.c_str());
+            auto location = lines.location(error.begin);
+            std::printf("error on line: %d, col: %d: %s (%.*s)\n", location.line, location.col, error.message(code).c_str(), static_cast<int>(error.text(code).size()), error.text(code).data());
         }
 
         return 1;
     }
 
-    for(const auto &token : tokens) {
-        std::printf("token: %s (%s)\n", cpp_lexer::Token::name(token.value), token.text.c_str());
-    }
-
-    TestParser parser;
-    parser.parse(tokens);
-
     return 0;
 }